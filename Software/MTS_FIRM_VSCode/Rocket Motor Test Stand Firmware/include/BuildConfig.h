@@ -0,0 +1,31 @@
+#pragma once
+
+/*
+Compile-time build configuration. Each option has its default here and can be overridden with a -D build flag,
+which is how the environments in platformio.ini make the different firmware variants. A feature that is turned off
+here is made a constant, so the compiler removes it and its branches instead of us checking it every loop.
+*/
+
+#ifndef MTS_VARIANT
+#define MTS_VARIANT "standard" // Printed at startup so you know which image is on the board
+#endif
+
+#ifndef MTS_BUZZER
+#define MTS_BUZZER 1 // 0 = silent build, no tone() calls at all and the BS config value is ignored
+#endif
+
+#ifndef MTS_LOG_DATA
+#define MTS_LOG_DATA 1 // 0 = nothing is logged to the SD card (bench testing only, same as logData = false)
+#endif
+
+#ifndef MTS_LOADCELL_TEST
+#define MTS_LOADCELL_TEST 1 // 0 = removes the 'T' command that prints loadcell values over Serial
+#endif
+
+#ifndef MTS_LOAD_SAMPLE_RATE_MS
+#define MTS_LOAD_SAMPLE_RATE_MS 50 // Minimum time between loadcell readings
+#endif
+
+#ifndef MTS_MOVING_AVE_SAMPLES
+#define MTS_MOVING_AVE_SAMPLES 50 // Burnout detection moving average size
+#endif
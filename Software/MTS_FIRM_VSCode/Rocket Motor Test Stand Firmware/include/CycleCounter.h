@@ -0,0 +1,14 @@
+#pragma once
+
+#include <Arduino.h>
+
+/*
+Free running 32-bit CPU cycle counter, used by the benchmark (MTS_BENCH) and trace (MTS_TRACE) builds.
+
+Runs on TCB2 at CLK_PER (16 MHz on the Nano Every) so one count is one CPU cycle. TCB2 is not used
+by millis(), tone() or the PWM pins we drive. The low 16 bits come from the timer, the high 16 from
+an overflow interrupt, so it wraps after ~268 s.
+*/
+
+void CycleCounterBegin();
+uint32_t CycleCount();
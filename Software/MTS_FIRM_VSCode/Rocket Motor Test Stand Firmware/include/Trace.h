@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+Hot path event tracer, compiled in with -DMTS_TRACE (env:nano_every_trace). Compiles to nothing otherwise.
+
+Every traced function/region records a 4-byte begin and end event into a static ring:
+  bits 31-25  event id (TraceId)
+  bit  24     1 = begin, 0 = end
+  bits 23-0   timestamp in 64 CPU cycle ticks (4 us at 16 MHz), from the TCB2 cycle counter - wraps every ~67 s
+When the ring is full the oldest events are overwritten. A loop records ~15 events, so 256 events is only the
+last ~16 loops. The first loop of a test that takes longer than the data log interval (a gap in the data file)
+triggers the ring: TRACE_POST_TRIGGER_EVENTS more events are recorded so we see how the stand recovered, then it
+freezes and holds the loops leading up to the gap. Without a slow loop it holds the last loops before the dump.
+The ring is written to TRCnnnn.BIN (8.3 name, nnnn = test number) when the data file is closed, then convert it
+on a computer with Software/MTS_Tools/mts_trace2json.
+*/
+
+#ifndef TRACE_RING_EVENTS
+#define TRACE_RING_EVENTS 256 // 1 KB of SRAM
+#endif
+
+#ifndef TRACE_POST_TRIGGER_EVENTS
+#define TRACE_POST_TRIGGER_EVENTS (TRACE_RING_EVENTS / 8) // ~2 loops after the gap, the rest is before it
+#endif
+
+#define TRACE_EVENTS(X) \
+  X(Loop) X(WatchCommands) X(GetLoadCellData) X(LoadCellUpdate) \
+  X(ManageStandby) X(ManageCountdown) X(ManageIgnition) X(ManageBurn) X(ManageEndBurnDataSafe) X(ManageEndBurnStandby) \
+  X(IndicateStandby) X(IndicateCountdown) X(IndicateIgnition) X(IndicateBurn) X(IndicateEndBurnStandby) X(IndicateAbort) \
+  X(WriteDataToSD) X(FormatRow) X(SDWrite) X(SDCommit) X(SerialPrint)
+
+enum TraceId : uint8_t {
+#define TRACE_ENUM(name) TRACE_##name,
+  TRACE_EVENTS(TRACE_ENUM)
+#undef TRACE_ENUM
+  TRACE_ID_COUNT
+};
+
+#ifdef MTS_TRACE
+
+void TraceRecord(uint8_t id, bool begin);
+void TraceTrigger();                  // Freezes the ring TRACE_POST_TRIGGER_EVENTS events from now, later triggers are ignored
+void TraceDump(const char *fileName); // Writes the ring to the SD card, empties it and re-arms the trigger
+
+struct TraceScope {
+  uint8_t id;
+  TraceScope(uint8_t traceId) : id(traceId) { TraceRecord(id, true); }
+  ~TraceScope() { TraceRecord(id, false); }
+};
+
+#define TRACE_SCOPE(name) TraceScope traceScope_##name(TRACE_##name)
+#define TRACE_BEGIN(name) TraceRecord(TRACE_##name, true)
+#define TRACE_END(name) TraceRecord(TRACE_##name, false)
+#define TRACE_TRIGGER() TraceTrigger()
+
+#else
+
+#define TRACE_SCOPE(name)
+#define TRACE_BEGIN(name)
+#define TRACE_END(name)
+#define TRACE_TRIGGER()
+
+#endif
@@ -0,0 +1,36 @@
+#include "CycleCounter.h"
+
+#if defined(MTS_BENCH) || defined(MTS_TRACE)
+
+static volatile uint16_t cycleCounterOverflows = 0;
+
+ISR(TCB2_INT_vect) {
+  TCB2.INTFLAGS = TCB_CAPT_bm;
+  cycleCounterOverflows++;
+}
+
+void CycleCounterBegin() {
+  TCB2.CTRLA = 0;
+  TCB2.CTRLB = TCB_CNTMODE_INT_gc; // Periodic interrupt, counts 0 - CCMP then wraps
+  TCB2.CCMP = 0xFFFF;
+  TCB2.CNT = 0;
+  TCB2.INTFLAGS = TCB_CAPT_bm;
+  TCB2.INTCTRL = TCB_CAPT_bm;
+  TCB2.CTRLA = TCB_CLKSEL_CLKDIV1_gc | TCB_ENABLE_bm;
+}
+
+uint32_t CycleCount() {
+  uint8_t oldSREG = SREG;
+  cli();
+
+  uint16_t high = cycleCounterOverflows;
+  uint16_t low = TCB2.CNT;
+
+  // The counter wrapped but the interrupt hasn't run yet (interrupts are off)
+  if ((TCB2.INTFLAGS & TCB_CAPT_bm) && low < 0x8000) high++;
+
+  SREG = oldSREG;
+  return ((uint32_t) high << 16) | low;
+}
+
+#endif
@@ -0,0 +1,75 @@
+#include "Trace.h"
+
+#if defined(MTS_TRACE)
+
+#include <SD.h>
+#include "CycleCounter.h"
+
+// TRCnnnn.BIN layout (little endian):
+//   "MTST", uint8 version, uint8 name count, uint16 tick length in ns, uint16 event count, uint8 1 if the ring overflowed
+//   the event names in id order, each null terminated
+//   the events, oldest first
+
+static const char *const traceNames[] = {
+#define TRACE_NAME(name) #name,
+  TRACE_EVENTS(TRACE_NAME)
+#undef TRACE_NAME
+};
+
+static uint32_t traceRing[TRACE_RING_EVENTS];
+static uint16_t traceHead = 0;
+static bool traceWrapped = false;
+static bool traceStarted = false;
+static bool traceTriggered = false;
+static uint16_t traceEventsLeft = 0; // Counts down after the trigger, the ring is frozen at 0
+
+void TraceRecord(uint8_t id, bool begin) {
+  if (traceTriggered) {
+    if (traceEventsLeft == 0) return;
+    traceEventsLeft--;
+  }
+  if (!traceStarted) { CycleCounterBegin(); traceStarted = true; }
+
+  uint32_t ticks = (CycleCount() >> 6) & 0x00FFFFFF;
+  traceRing[traceHead] = ((uint32_t) id << 25) | ((uint32_t) begin << 24) | ticks;
+
+  if (++traceHead >= TRACE_RING_EVENTS) { traceHead = 0; traceWrapped = true; }
+}
+
+void TraceTrigger() {
+  if (traceTriggered) return; // Keep the first gap, the rest are usually the same problem
+  traceTriggered = true;
+  traceEventsLeft = TRACE_POST_TRIGGER_EVENTS;
+}
+
+void TraceDump(const char *fileName) {
+  File traceFile = SD.open(fileName, FILE_WRITE | O_TRUNC);
+  if (!traceFile) { Serial.println("Error writing trace file."); return; }
+
+  uint16_t count = traceWrapped ? TRACE_RING_EVENTS : traceHead;
+  uint16_t tick_ns = (uint16_t) (64000000000ULL / F_CPU);
+  uint8_t header[11] = { 'M', 'T', 'S', 'T', 1, TRACE_ID_COUNT,
+                         (uint8_t) tick_ns, (uint8_t) (tick_ns >> 8), (uint8_t) count, (uint8_t) (count >> 8), traceWrapped };
+  traceFile.write(header, sizeof(header));
+
+  for (uint8_t i = 0; i < TRACE_ID_COUNT; i++) traceFile.write((const uint8_t *) traceNames[i], strlen(traceNames[i]) + 1);
+
+  // Oldest first - if we wrapped, the oldest event is the one at the head
+  uint16_t start = traceWrapped ? traceHead : 0;
+  for (uint16_t i = 0; i < count; i++) {
+    uint32_t event = traceRing[(start + i) % TRACE_RING_EVENTS];
+    traceFile.write((const uint8_t *) &event, sizeof(event));
+  }
+
+  traceFile.close();
+
+  traceHead = 0;
+  traceWrapped = false;
+  Serial.print(" > Trace saved to ");
+  Serial.print(fileName);
+  Serial.println(traceTriggered ? " (frozen at the first slow loop)" : " (no slow loops, last events before the file was closed)");
+
+  traceTriggered = false;
+}
+
+#endif
@@ -2,11 +2,21 @@
 #include <SPI.h>
 #include <SD.h>
 #include <Arduino.h>
+#include "BuildConfig.h"
+#include "Trace.h"
+
+#ifdef MTS_BENCH
+#include "CycleCounter.h"
+#endif
 
 /*
 This program is licenced under the Creative Commons Zero V1.0 Universal Licence
 
 - Settings Are Changed In The Config File And Are Automatically Applied
+- After a test, send 'R' to re-arm for the next motor without power cycling (calibration is kept, loadcell is re-tared)
+- Features and fixed values can also be set at compile time, see include/BuildConfig.h and the environments in platformio.ini
+- Build with -DMTS_BENCH (env:nano_every_bench) to time the hot functions instead of running a test
+- Build with -DMTS_TRACE (env:nano_every_trace) to record a timeline of the loops around the first gap in the data to TRCnnnn.BIN
 */
 
 //SD
@@ -14,7 +24,11 @@ File dataFile;
 File configFile;
 String dataFileName;
 const int sdChipSelect = 8;
+#if MTS_LOG_DATA
 bool logData = true; // Should always be true unless system is being tested
+#else
+const bool logData = false; // No-log build
+#endif
 int dataLogIntervalSlow_ms = 100; //Constants for data log period.
 int dataLogIntervalFast_ms = 10;
 int dataLogInterval_ms = 100;
@@ -25,7 +39,7 @@ int testNumber = 0;
 float motorLoadThreshold = 10;
 const int HX711_dout = 9; // HX711 dout pin
 const int HX711_sck = 10; // HX711 sck pin
-const int loadSampleRate = 50; 
+const int loadSampleRate = MTS_LOAD_SAMPLE_RATE_MS; 
 float currentCellData = 0; // Current value of load cell -> declared here so that it can be referenced anywhere
 float globalLoadMovingAve; //Just for reading
 float calibrationValueFromConfig; //Calibration Value stored in the config file on the SD card
@@ -37,15 +51,26 @@ HX711_ADC LoadCell(HX711_dout, HX711_sck);
 //System
 bool sysArmed = false;
 bool ABORT = false;
+#if MTS_LOADCELL_TEST
 bool testLoadcell = false;
+#else
+const bool testLoadcell = false;
+#endif
 int systemState = 0;
 const int stateIndicatorLED_GRN = 3;
 const int stateIndicatorLED_RED = 5;
 const int stateIndicatorLED_BLU = 2;
 const int ignitionPyroPin = 4;
 const int indicatorBuzzer = 6;
+#if MTS_BUZZER
 bool allowBuzzer = true;
-float loopTime, aveLoopTime, timeOfLastLoop;
+#else
+const bool allowBuzzer = false; // Silent build
+#endif
+unsigned long loopTime, timeOfLastLoop; // unsigned long like micros(), so the subtraction stays right when it wraps (~71 min)
+float aveLoopTime;
+unsigned long loopTimeSum, loopTimeMin, loopTimeMax, loopCount = 0; // Every loop from countdown to the end of data safe, reported when the test ends
+bool loopTimerStarted = false;
 
 //Time
 unsigned long cellTime, sdTime, statusIndTime, statusIndTimeLocked, dataSafeEndTime, loopTimeGlobal, systemOnTime_s = 0;
@@ -66,6 +91,8 @@ void InitializePins();
 void IndicateStartup();
 void InitializeCell();
 void InitializeSD();
+void OpenDataFile();
+void ReArm();
 void ProcessConfig();
 void PrintSettings();
 void CalibrateCell();
@@ -81,9 +108,13 @@ void IndicateAbort();
 void EndDataWrite();
 void SaveLoadCellCalibrationValueToConfig(float calValue);
 void UpdateTestNumberInConfig();
+bool TestFileName(char *name, const char *prefix, int number, const char *extension);
 void ProcessVariableLine(String line);
 void CalcLoopTime();
-float MovingLoadAve(float value);
+void ReportLoopTime();
+float MovingLoadAve(float value, bool reset = false);
+int availableMemory();
+void RunBenchmarks();
 
 void setup() {
   
@@ -97,7 +128,13 @@ void setup() {
   InitializeSD();
   InitializeCell();
   ProcessConfig();
+
+#ifdef MTS_BENCH
+  RunBenchmarks(); // Doesn't return. Runs before the test number goes up, so benchmarking doesn't use up test numbers
+#endif
+
   UpdateTestNumberInConfig();  // Updates the Test Number value in the config file
+  OpenDataFile();              // Named after the test number, so this has to come after the config
   PrintSettings();
 
   testTime_s = -countdownLength_s;
@@ -113,6 +150,7 @@ void setup() {
 }
 
 void loop() {
+  TRACE_SCOPE(Loop);
 
   WatchCommands();
 
@@ -176,11 +214,18 @@ void loop() {
 //==GENERAL FUNCTIONS==
 
 void WatchCommands() {
+  TRACE_SCOPE(WatchCommands);
   if (Serial.available() > 0) {
     char inByte = Serial.read();
     if (inByte == 'S') sysArmed = true;
-    if (inByte == 'A') systemState = 42;
+    if (inByte == 'A') {
+      if (systemState >= 1 && systemState <= 4) ReportLoopTime(); // Aborting a running test
+      systemState = 42;
+    }
+    if (inByte == 'R' && (systemState == 5 || systemState == 42)) ReArm(); // Only once the test is over
+#if MTS_LOADCELL_TEST
     if (inByte == 'T') testLoadcell = !testLoadcell;// Displays loadcell values in Serial Monitor
+#endif
   }
 }
 
@@ -195,6 +240,7 @@ void InitializePins() {
 
 void PrintSettings() {
   Serial.println();
+  Serial.println("Build: " MTS_VARIANT);
   Serial.print("Countdown Length: ");
   Serial.print(countdownLength_s);
   Serial.println("s");
@@ -314,13 +360,16 @@ void CalibrateCell() { //Calibrate load cell
 }
 
 void GetLoadCellData() { //Gets data from loadcell
+  TRACE_SCOPE(GetLoadCellData);
   static boolean newDataReady = 0;
 
   // check for new data/start next conversion:
+  TRACE_BEGIN(LoadCellUpdate);
   if (LoadCell.update()) newDataReady = true;
+  TRACE_END(LoadCellUpdate);
 
   // get smoothed value from the dataset:
-  if (newDataReady && logData) {
+  if (newDataReady) {
     if (millis() > cellTime + loadSampleRate && loadCellIsCalibrated) {
       float i = LoadCell.getData();
       currentCellData = i;
@@ -351,30 +400,35 @@ void InitializeSD() { //Initializes the SD card reader
     while (1);
   }
 
-  // Prep data file with headers
-
-  dataFileName = "Data_Test" + String(testNumber + 1) + ".csv"; // We do + 1 Because we haven't updated TestNumber yet
-  dataFileName = "data.csv";
+  if (allowBuzzer) { tone(indicatorBuzzer, 1500, 50); }
 
-  String headerString = "System_State, System_On_Time_s, Test_Time_s, Load_Cell_Data_g, Load_Cell_Data_Ave_g, Calibration_State, Data_Log_Interval_ms, Data_Log_Rate_Hz, Loop_Run_Time_micros, Available_Memory_b";
+  Serial.println("done.");
+}
 
-  dataFile = SD.open(dataFileName, FILE_WRITE);
+void OpenDataFile() { // Creates this test's data file and writes the headers
 
-  dataFile.println(headerString);
+  if (!logData) return; // No-log build, leave the card alone
 
-  dataFile.close();
+  char name[13];
+  if (!TestFileName(name, "TEST", testNumber, "CSV")) {
+    Serial.println("Error: test number " + String(testNumber) + " doesn't fit in an 8.3 file name, lower TN in config.txt");
+    return;
+  }
+  dataFileName = name;
 
-  Serial.println(dataFile);
+  String headerString = "System_State, System_On_Time_s, Test_Time_s, Load_Cell_Data_g, Load_Cell_Data_Ave_g, Calibration_State, Data_Log_Interval_ms, Data_Log_Rate_Hz, Loop_Run_Time_micros, Available_Memory_b";
 
-  // We reopen the datafile to save processing time. The datafile is opened and closed once. This means while 
-  // we will save processing time, we will lose all recorded data if the system crashes (usually due to a voltage drop).
+  // The datafile is opened once and kept open to save processing time. This means while we will save processing time,
+  // we will lose all recorded data if the system crashes (usually due to a voltage drop).
   // This could be solved by utilising non-volatile memory like a flash chip, but this system does not use any.
   // If the chance of a crash is high, then open and close the datafile each time you write. (We should not be operating if this is the case.)
-  dataFile = SD.open(dataFileName, FILE_WRITE); 
+  // The headers are flushed straight away so the file is on the card even if we never get to log anything.
+  dataFile = SD.open(dataFileName, FILE_WRITE);
 
-  if (allowBuzzer) { tone(indicatorBuzzer, 1500, 50); }
+  dataFile.println(headerString);
+  dataFile.flush();
 
-  Serial.println("done.");
+  if (!dataFile) Serial.println("Error opening " + dataFileName);
 }
 
 void ProcessConfig() { //Processes config file
@@ -432,7 +486,9 @@ void ProcessVariableLine(String line) { //Extracts variable values from line
   } else if (varName == "DLS") {
     dataLogIntervalSlow_ms = varValStr.toInt();
   } else if (varName == "BS") {
+#if MTS_BUZZER
     allowBuzzer = varValStr.toInt();
+#endif
   } else if (varName == "DSL") {
     dataSafeLength_s = varValStr.toFloat();
   } else if (varName == "TN") {
@@ -462,19 +518,39 @@ void SaveLoadCellCalibrationValueToConfig(float calValue) { // Saves calibration
   Serial.println(" > Calibration Value Saved to Config.");
 }
 
+bool TestFileName(char *name, const char *prefix, int number, const char *extension) { // e.g. TEST0012.CSV into name[13], false if it isn't 8.3
+  // The SD library can't do long names, so everything named after the test number goes through here
+  int baseLength = snprintf(name, 13, "%s%04d", prefix, number);
+  if (baseLength < 0 || baseLength > 8 || strlen(extension) > 3) {
+    name[0] = '\0';
+    return false;
+  }
+  strcat(name, ".");
+  strcat(name, extension);
+  return true;
+}
+
 void UpdateTestNumberInConfig() { // Increments the TestNumber value by one in the config file - used for data file naming
 
   // This function ensures we have a cronological and unique way of naming datafiles as to not contaminate or erase existing data
   // It will also prevent having to access and store the data on the SD card between burns 
 
+  if (!logData) return; // No-log build, nothing gets named after it
+
   configFile = SD.open("config.txt", FILE_READ);
   String fileContent = configFile.readString();
 
-  Serial.println(testNumber); // TESTING
+  testNumber += 1;
 
-  fileContent.replace('TN ' + String(testNumber), 'TN ' + String(testNumber + 1));
+  // Never append to an earlier test's file, e.g. if TN was reset or the card came from another stand
+  char name[13];
+  while (TestFileName(name, "TEST", testNumber, "CSV") && SD.exists(name)) testNumber += 1;
 
-  testNumber += 1;
+  // Rewrites whatever is between "*TN:" and ';', ProcessVariableLine() doesn't care about the spacing either
+  int tnStart = fileContent.indexOf("*TN:");
+  int tnEnd = tnStart < 0 ? -1 : fileContent.indexOf(';', tnStart);
+  if (tnEnd < 0) Serial.println("Error: no *TN: line in config.txt, the test number won't be saved");
+  else fileContent = fileContent.substring(0, tnStart) + "*TN: " + String(testNumber) + fileContent.substring(tnEnd);
 
   configFile.close();
 
@@ -483,13 +559,12 @@ void UpdateTestNumberInConfig() { // Increments the TestNumber value by one in t
   configFile.println(fileContent);
 
   configFile.close();
-
-  Serial.println(dataFileName); // TESTING
 }
 
 void WriteDataToSD() {
+  TRACE_SCOPE(WriteDataToSD);
 
-  // DataFile is opened in initializeSD() and closed in ManageBurn().
+  // DataFile is opened in OpenDataFile() and closed in ManageEndBurnStandby().
 
   unsigned long dataLogRate_hz = 1000 / dataLogInterval_ms;
 
@@ -497,7 +572,13 @@ void WriteDataToSD() {
 
   // Check comments at end if InitializeSD for why we don't close datafile here
   if (millis() > sdTime + dataLogInterval_ms && dataFile && logData) {
-    dataFile.println(String(systemState) + ", " + String(systemOnTime_s) + ", " + String(testTime_s) + ", "+ String(currentCellData) + ", " + String(globalLoadMovingAve) + ", " + String(cellCalibrationState) + ", " + String(dataLogInterval_ms) + ", " + String(dataLogRate_hz) + ", " + String(loopTimeGlobal) + ", " + String(availableMemory())); 
+    TRACE_BEGIN(FormatRow);
+    String row = String(systemState) + ", " + String(systemOnTime_s) + ", " + String(testTime_s) + ", "+ String(currentCellData) + ", " + String(globalLoadMovingAve) + ", " + String(cellCalibrationState) + ", " + String(dataLogInterval_ms) + ", " + String(dataLogRate_hz) + ", " + String(loopTimeGlobal) + ", " + String(availableMemory());
+    TRACE_END(FormatRow);
+
+    TRACE_BEGIN(SDWrite);
+    dataFile.println(row);
+    TRACE_END(SDWrite);
     sdTime = millis(); 
   }
 
@@ -505,8 +586,17 @@ void WriteDataToSD() {
 }
 
 void EndDataWrite() { 
+  TRACE_BEGIN(SDCommit);
   dataFile.close();
+  TRACE_END(SDCommit);
+#if MTS_LOG_DATA
   logData = false;
+#endif
+
+#ifdef MTS_TRACE
+  char traceFileName[13];
+  if (TestFileName(traceFileName, "TRC", testNumber, "BIN")) TraceDump(traceFileName);
+#endif
 }
 
 //==SYSTEM==  
@@ -518,17 +608,21 @@ void AdvanceState() {
 }
 
 void ManageStandby() {
+  TRACE_SCOPE(ManageStandby);
   if (sysArmed == true) {
     AdvanceState(); 
     countdownEndTime_ms = millis() + (countdownLength_s * 1000);
   }
 
   if (testLoadcell) {
+      TRACE_BEGIN(SerialPrint);
       Serial.println(currentCellData);
+      TRACE_END(SerialPrint);
     }
 }
 
 void ManageCountdown() {
+  TRACE_SCOPE(ManageCountdown);
 
   dataLogInterval_ms = dataLogIntervalSlow_ms;
 
@@ -538,12 +632,14 @@ void ManageCountdown() {
 } 
 
 void ManageIgnition() { 
+  TRACE_SCOPE(ManageIgnition);
   dataLogInterval_ms = dataLogIntervalFast_ms;
 
   if (currentCellData > motorLoadThreshold) AdvanceState(); digitalWrite(ignitionPyroPin, LOW);
 }
 
 void ManageBurn() {
+  TRACE_SCOPE(ManageBurn);
   digitalWrite(ignitionPyroPin, LOW);
 
   if (MovingLoadAve(currentCellData) < motorLoadThreshold) {
@@ -553,16 +649,57 @@ void ManageBurn() {
 }
 
 void ManageEndBurnDataSafe() { // Ensures that we do not lose data if the system mistakenly ends data recording
+  TRACE_SCOPE(ManageEndBurnDataSafe);
   if (currentCellData > motorLoadThreshold) {
     systemState--;
   }
 
   if (dataSafeEndTime <= millis()) {
     AdvanceState();
+    ReportLoopTime(); // Here rather than when the data file is closed, so the no-log build reports too
   }
 }
 
+void ReArm() { // Gets everything ready for the next test. The SD card stays mounted and the loadcell stays warm and calibrated.
+  if (dataFile) EndDataWrite();
+
+  // State machine
+  systemState = 0;
+  sysArmed = false;
+  ABORT = false;
+  digitalWrite(ignitionPyroPin, LOW);
+  ResetIndicators();
+
+  // Filters and analytics
+  MovingLoadAve(0, true);
+  currentCellData = 0;
+  aveLoopTime = 0;
+  loopTimeSum = loopTimeMin = loopTimeMax = loopCount = 0;
+  loopTimerStarted = false;
+
+  // Timers
+  countdownEndTime_ms = 0;
+  dataSafeEndTime = 0;
+  testTime_s = -countdownLength_s;
+  statusIndTime = statusIndTimeLocked = 0;
+  sdTime = 0;
+  dataLogInterval_ms = dataLogIntervalSlow_ms;
+
+  // The next motor is on the stand now, so zero it out. Completes in the background as new readings come in.
+  LoadCell.tareNoDelay();
+
+  // Next data file
+#if MTS_LOG_DATA
+  logData = true;
+#endif
+  UpdateTestNumberInConfig();
+  OpenDataFile();
+
+  Serial.println(" > Re-armed for test " + String(testNumber) + ". Standing By.");
+}
+
 void ManageEndBurnStandby() {
+  TRACE_SCOPE(ManageEndBurnStandby);
   if (dataFile) {
     EndDataWrite();
   }
@@ -572,15 +709,23 @@ void FireIgnitionPyro() {
   digitalWrite(ignitionPyroPin, HIGH);
 }
 
-float MovingLoadAve(float value) { // Not my own function, in here just because it can be 0.0
+float MovingLoadAve(float value, bool reset) { // Not my own function, in here just because it can be 0.0
 
-  const int nvalues = 50; // Moving average sample size
+  const int nvalues = MTS_MOVING_AVE_SAMPLES; // Moving average sample size
 
   static int current = 0; // Moving average window size
   static int cvalues = 0; // Count of values read
   static float sum = 0;
   static float values[nvalues];
 
+  if (reset) { // Start a fresh window for the next test
+    current = 0;
+    cvalues = 0;
+    sum = 0;
+    globalLoadMovingAve = 0;
+    return 0;
+  }
+
   sum += value;
   
   if (cvalues == nvalues) {
@@ -599,9 +744,28 @@ float MovingLoadAve(float value) { // Not my own function, in here just because
 }
 
 void CalcLoopTime() { // Calculates Time of one clock cycle
-  loopTime = micros() - timeOfLastLoop;
-  timeOfLastLoop = micros();
-  if (loopTime < 60000) { loopTimeGlobal = loopTime; }
+  unsigned long now = micros();
+  loopTime = now - timeOfLastLoop;
+  timeOfLastLoop = now;
+
+  // Called every loop in states 1 - 4. The first one only starts the timer, the loop before it was in standby.
+  if (!loopTimerStarted) {
+    loopTimerStarted = true;
+    return;
+  }
+
+  if (loopTime < 60000) { loopTimeGlobal = loopTime; } // Only the logged value is clamped, the stats keep SD stalls
+  if (loopTime > dataLogInterval_ms * 1000UL) TRACE_TRIGGER(); // Missed a row, keep the loops that led up to it
+
+  loopTimeSum += loopTime;
+  if (loopCount == 0 || loopTime < loopTimeMin) loopTimeMin = loopTime;
+  if (loopTime > loopTimeMax) loopTimeMax = loopTime;
+  loopCount++;
+}
+
+void ReportLoopTime() { // Every variant reports this, logging or not
+  aveLoopTime = loopCount > 0 ? (float) loopTimeSum / loopCount : 0;
+  Serial.println("Loop time (us) min: " + String(loopTimeMin) + " mean: " + String(aveLoopTime) + " max: " + String(loopTimeMax) + " over " + String(loopCount) + " loops");
 }
 
 //==TIME==
@@ -639,6 +803,7 @@ void IndicateStartup() {
 }
 
 void IndicateStandby() {
+  TRACE_SCOPE(IndicateStandby);
 
   if (millis() > statusIndTime + 100) {
     
@@ -665,6 +830,7 @@ void IndicateStandby() {
 }
 
 void IndicateCountdown() {
+  TRACE_SCOPE(IndicateCountdown);
   
   if (millis() > statusIndTime + 100) {
 
@@ -690,6 +856,7 @@ void IndicateCountdown() {
 }
 
 void IndicateIgnition() {
+  TRACE_SCOPE(IndicateIgnition);
   if (millis() > statusIndTime + 100) {
 
     if (statusIndTimeLocked >= 1000) {
@@ -710,6 +877,7 @@ void IndicateIgnition() {
 }
 
 void IndicateBurn() {
+  TRACE_SCOPE(IndicateBurn);
   if (millis() > statusIndTime + 100) {
 
     if (statusIndTimeLocked >= 1000) {
@@ -734,6 +902,7 @@ void IndicateBurn() {
 }
 
 void IndicateEndBurnStandby() {
+  TRACE_SCOPE(IndicateEndBurnStandby);
   if (millis() > statusIndTime + 100) {
 
     if (statusIndTimeLocked >= 3000) {
@@ -758,6 +927,7 @@ void IndicateEndBurnStandby() {
 }
 
 void IndicateAbort() {
+  TRACE_SCOPE(IndicateAbort);
   if (millis() > statusIndTime + 100) {
 
     if (statusIndTimeLocked >= 3000) {
@@ -787,4 +957,96 @@ void ResetIndicators() {
   digitalWrite(stateIndicatorLED_RED, LOW);
 
   digitalWrite(indicatorBuzzer, LOW);
-}
\ No newline at end of file
+}
+
+//==BENCHMARK==
+// Times each hot function in isolation with the TCB2 cycle counter and prints the results over Serial as CSV,
+// in the same format as the host benchmark (Software/MTS_Tools/mts_bench) so the two can be compared.
+
+#ifdef MTS_BENCH
+
+const int benchWarmUpCalls = 4;
+const int benchSamples = 32;
+String benchConfigLine; // Built once in RunBenchmarks() so we only time the parsing
+
+// The one timed path, so the overhead is measured through the same indirect call as every sample.
+// noinline/noclone stop the compiler making a copy with the function pointer known and the call inlined.
+__attribute__((noinline, noclone)) void BenchRun(void (*setUp)(), void (*function)(), uint32_t overhead, uint32_t *samples) {
+  for (int i = 0; i < benchWarmUpCalls; i++) { setUp(); function(); }
+
+  for (int i = 0; i < benchSamples; i++) {
+    setUp();
+    uint32_t start = CycleCount();
+    function();
+    uint32_t cycles = CycleCount() - start;
+    samples[i] = cycles > overhead ? cycles - overhead : 0;
+  }
+
+  // Insertion sort, it's 32 values
+  for (int i = 1; i < benchSamples; i++) {
+    uint32_t v = samples[i];
+    int j = i - 1;
+    while (j >= 0 && samples[j] > v) { samples[j + 1] = samples[j]; j--; }
+    samples[j + 1] = v;
+  }
+}
+
+void BenchFunction(const char *name, void (*setUp)(), void (*function)(), uint32_t overhead) {
+  uint32_t samples[benchSamples];
+  BenchRun(setUp, function, overhead, samples);
+
+  uint32_t sum = 0;
+  for (int i = 0; i < benchSamples; i++) sum += samples[i];
+
+  Serial.print(name);
+  Serial.print(", cycles, ");
+  Serial.print(benchSamples);
+  Serial.print(", ");
+  Serial.print(samples[0]);
+  Serial.print(", ");
+  Serial.print(samples[benchSamples / 2]);
+  Serial.print(", ");
+  Serial.print(sum / benchSamples);
+  Serial.print(", ");
+  Serial.println(samples[benchSamples - 1]);
+}
+
+void BenchNothing() {}
+
+void BenchWriteDataToSDSetUp() { sdTime = 0; } // Makes sure the log interval has passed so every call writes a row
+
+void BenchWriteDataToSD() { WriteDataToSD(); }
+void BenchMovingLoadAve() { MovingLoadAve(currentCellData); }
+void BenchAvailableMemory() { availableMemory(); }
+void BenchProcessVariableLine() { ProcessVariableLine(benchConfigLine); }
+void BenchTimeKeeper() { TimeKeeper(); }
+
+void RunBenchmarks() {
+  Serial.println("\n > Running benchmarks (F_CPU " + String(F_CPU / 1000000) + " MHz). Copy the lines below into a .csv to compare runs.\n");
+  CycleCounterBegin();
+
+  // WriteDataToSD() writes to a scratch file that is deleted afterwards, so the card is left as it was
+  dataFileName = "BENCH.CSV";
+  dataFile = SD.open(dataFileName, FILE_WRITE);
+
+  benchConfigLine = "*DSL: " + String(dataSafeLength_s) + ";"; // Sets DSL to what it already is
+
+  // What an empty call costs through BenchRun(), taken off every sample
+  uint32_t overheadSamples[benchSamples];
+  BenchRun(BenchNothing, BenchNothing, 0, overheadSamples);
+  uint32_t overhead = overheadSamples[0];
+
+  Serial.println("Function, Unit, Samples, Min, Median, Mean, Max");
+  BenchFunction("WriteDataToSD", BenchWriteDataToSDSetUp, BenchWriteDataToSD, overhead);
+  BenchFunction("MovingLoadAve", BenchNothing, BenchMovingLoadAve, overhead);
+  BenchFunction("availableMemory", BenchNothing, BenchAvailableMemory, overhead);
+  BenchFunction("ProcessVariableLine", BenchNothing, BenchProcessVariableLine, overhead);
+  BenchFunction("TimeKeeper", BenchNothing, BenchTimeKeeper, overhead);
+
+  dataFile.close();
+  SD.remove(dataFileName.c_str());
+  Serial.println("\n > Benchmarks done.");
+  while (1);
+}
+
+#endif
@@ -0,0 +1,51 @@
+// Host stand-in for the parts of Arduino.h the firmware uses
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring> // The real Arduino.h pulls in string.h and stdio.h too
+#include <deque>
+
+#include "WString.h"
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x0
+#define OUTPUT 0x1
+
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int value);
+void tone(int pin, unsigned int frequency, unsigned long duration = 0);
+void noTone(int pin);
+void delay(unsigned long ms);
+unsigned long millis();
+unsigned long micros();
+
+class HardwareSerial {
+public:
+  void begin(unsigned long baud);
+  int available();
+  int read();
+  float parseFloat();
+
+  void print(const String &s);
+  void print(const char *s);
+  void print(char c);
+  void print(int v);
+  void print(unsigned int v);
+  void print(long v);
+  void print(unsigned long v);
+  void print(double v);
+
+  void println();
+  template <typename T> void println(const T &v) { print(v); println(); }
+
+  std::deque<char> input;
+};
+
+extern HardwareSerial Serial;
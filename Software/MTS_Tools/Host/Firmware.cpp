@@ -0,0 +1,2 @@
+// Compiles the firmware unmodified against the host shim
+#include "../../MTS_FIRM_VSCode/Rocket Motor Test Stand Firmware/src/main.cpp"
@@ -0,0 +1,33 @@
+// Host stand-in for HX711_ADC. Conversions happen at Host::hx711Rate_sps and read Host::loadSource (already in grams).
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class HX711_ADC {
+public:
+  HX711_ADC(uint8_t dout, uint8_t sck) { (void) dout; (void) sck; }
+
+  void begin() {}
+  void start(unsigned long stabilizingTime_ms, bool tare);
+  uint8_t update();
+  float getData() const;
+
+  void setCalFactor(float) {} // loadSource is already calibrated
+  void refreshDataSet();
+  void tareNoDelay() { tareDone_ = true; }
+  bool getTareStatus() { bool done = tareDone_; tareDone_ = false; return done; }
+  bool getTareTimeoutFlag() const { return false; }
+  bool getSignalTimeoutFlag() const { return false; }
+  float getNewCalibration(float knownMass) { (void) knownMass; return 1.0f; }
+
+private:
+  void Convert();
+
+  std::vector<float> dataset_;
+  size_t next_ = 0;
+  uint64_t nextConversion_us_ = 0;
+  bool tareDone_ = false;
+};
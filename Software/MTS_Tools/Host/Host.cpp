@@ -0,0 +1,203 @@
+// Host shim implementation - see Host.h
+
+#include "Host.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <map>
+
+#include "Arduino.h"
+#include "HX711_ADC.h"
+#include "SD.h"
+
+namespace Host {
+
+  uint64_t now_us = 0;
+  std::function<float(double)> loadSource = [](double) { return 0.0f; };
+  std::function<void(int, int)> onDigitalWrite = [](int, int) {};
+
+  float hx711Rate_sps = 80;
+  int hx711Samples = 16;
+  uint32_t sdWriteCost_us = 3000;
+  bool echoSerial = false;
+
+  static std::map<std::string, std::string> sdCard;
+
+  void Advance(uint64_t us) { now_us += us; }
+
+  void SerialInput(const std::string &text) { Serial.input.insert(Serial.input.end(), text.begin(), text.end()); }
+
+  std::string &SdFile(const std::string &name) { return sdCard[name]; }
+
+  bool SdHasFile(const std::string &name) { return sdCard.count(name) != 0; }
+
+}
+
+//==ARDUINO==
+
+HardwareSerial Serial;
+SDClass SD;
+
+void pinMode(int, int) {}
+void digitalWrite(int pin, int value) { Host::onDigitalWrite(pin, value); }
+void tone(int, unsigned int, unsigned long) {}
+void noTone(int) {}
+void delay(unsigned long ms) { Host::Advance(ms * 1000ull); }
+// Truncated to unsigned long like the board, which only wraps when that's 32 bit (make M32=1)
+unsigned long millis() { return (unsigned long) (Host::now_us / 1000); }
+unsigned long micros() { return (unsigned long) Host::now_us; }
+
+void HardwareSerial::begin(unsigned long) {}
+int HardwareSerial::available() { return (int) input.size(); }
+
+int HardwareSerial::read() {
+  if (input.empty()) return -1;
+  char c = input.front();
+  input.pop_front();
+  return c;
+}
+
+float HardwareSerial::parseFloat() { // Like Stream::parseFloat - skips to the first number and stops at the first character after it
+  std::string number;
+  while (!input.empty() && !(isdigit((unsigned char) input.front()) || input.front() == '-' || input.front() == '.')) input.pop_front();
+  while (!input.empty() && (isdigit((unsigned char) input.front()) || input.front() == '-' || input.front() == '.')) { number += input.front(); input.pop_front(); }
+  return number.empty() ? 0 : strtof(number.c_str(), nullptr);
+}
+
+void HardwareSerial::print(const String &s) { if (Host::echoSerial) fputs(s.c_str(), stderr); }
+void HardwareSerial::print(const char *s) { print(String(s)); }
+void HardwareSerial::print(char c) { print(String(c)); }
+void HardwareSerial::print(int v) { print(String(v)); }
+void HardwareSerial::print(unsigned int v) { print(String(v)); }
+void HardwareSerial::print(long v) { print(String(v)); }
+void HardwareSerial::print(unsigned long v) { print(String(v)); }
+void HardwareSerial::print(double v) { print(String(v)); }
+void HardwareSerial::println() { print("\r\n"); }
+
+//==STRING==
+
+String::String(double v, unsigned int decimals) {
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%.*f", (int) decimals, v);
+  s_ = buffer;
+}
+
+char &String::operator[](unsigned int i) {
+  static char dummy;
+  if (i >= s_.size()) { dummy = 0; return dummy; }
+  return s_[i];
+}
+
+int String::indexOf(char c, unsigned int from) const {
+  size_t i = s_.find(c, from);
+  return i == std::string::npos ? -1 : (int) i;
+}
+
+int String::indexOf(const String &s, unsigned int from) const {
+  size_t i = s_.find(s.s_, from);
+  return i == std::string::npos ? -1 : (int) i;
+}
+
+String String::substring(unsigned int begin, unsigned int end) const {
+  if (begin > end) std::swap(begin, end); // Like the board's version
+  if (begin >= s_.size()) return String();
+  return String(s_.substr(begin, std::min<size_t>(end, s_.size()) - begin));
+}
+
+long String::toInt() const { return atol(s_.c_str()); }
+float String::toFloat() const { return (float) atof(s_.c_str()); }
+
+void String::replace(const String &find, const String &replacement) {
+  if (find.s_.empty()) return;
+  for (size_t i = s_.find(find.s_); i != std::string::npos; i = s_.find(find.s_, i + replacement.s_.size())) {
+    s_.replace(i, find.s_.size(), replacement.s_);
+  }
+}
+
+//==SD==
+
+bool SDClass::begin(int) { return true; }
+bool SDClass::exists(const char *name) { return Host::SdHasFile(name); }
+
+static bool IsShortName(const std::string &path) { // The SD library only opens 8.3 names, so catch long ones here instead of on the stand
+  size_t begin = path.find_last_of('/') + 1;
+  size_t dot = path.find('.', begin);
+  size_t baseLength = (dot == std::string::npos ? path.size() : dot) - begin;
+  size_t extensionLength = dot == std::string::npos ? 0 : path.size() - dot - 1;
+  if (baseLength == 0 || baseLength > 8 || extensionLength > 3) return false;
+
+  for (size_t i = begin; i < path.size(); i++) {
+    if (i != dot && !isalnum((unsigned char) path[i]) && !strchr("$%'-_@~`!(){}^#&", path[i])) return false;
+  }
+  return true;
+}
+
+File::File(const std::string &name, int mode) : name_(name) {
+  if (!IsShortName(name)) {
+    fprintf(stderr, "! SD.open(\"%s\") fails on the card, not an 8.3 name\n", name.c_str());
+    return;
+  }
+  writable_ = (mode & 0x02) != 0;
+  if (!writable_ && !Host::SdHasFile(name)) return;
+
+  std::string &content = Host::SdFile(name);
+  if (mode & O_TRUNC) content.clear();
+  position_ = writable_ ? content.size() : 0;
+  open_ = true;
+}
+
+void File::print(const String &s) {
+  if (!open_ || !writable_) return;
+  Host::SdFile(name_) += s.c_str();
+  Host::Advance(Host::sdWriteCost_us);
+}
+
+void File::println(const String &s) { print(s + "\r\n"); }
+
+String File::readString() {
+  if (!open_) return String();
+  const std::string &content = Host::SdFile(name_);
+  String rest(content.substr(std::min(position_, content.size())));
+  position_ = content.size();
+  return rest;
+}
+
+//==HX711==
+
+void HX711_ADC::start(unsigned long stabilizingTime_ms, bool) {
+  delay(stabilizingTime_ms);
+  refreshDataSet();
+}
+
+void HX711_ADC::refreshDataSet() { // The library's dataset holds SAMPLES readings plus the highest and lowest, which are thrown away
+  dataset_.assign(Host::hx711Samples + 2, Host::loadSource(Host::now_us / 1e6));
+  next_ = 0;
+  nextConversion_us_ = Host::now_us;
+}
+
+void HX711_ADC::Convert() {
+  dataset_[next_] = Host::loadSource(nextConversion_us_ / 1e6);
+  next_ = (next_ + 1) % dataset_.size();
+}
+
+uint8_t HX711_ADC::update() {
+  if (dataset_.empty()) refreshDataSet();
+
+  uint8_t newData = 0;
+  uint64_t period_us = (uint64_t) (1e6 / Host::hx711Rate_sps);
+  while (nextConversion_us_ + period_us <= Host::now_us) {
+    nextConversion_us_ += period_us;
+    Convert();
+    newData = 1;
+  }
+  return newData;
+}
+
+float HX711_ADC::getData() const {
+  if (dataset_.empty()) return 0;
+  float sum = 0, lowest = dataset_[0], highest = dataset_[0];
+  for (float v : dataset_) { sum += v; lowest = std::min(lowest, v); highest = std::max(highest, v); }
+  return (sum - lowest - highest) / (dataset_.size() - 2);
+}
@@ -0,0 +1,31 @@
+/*
+Host shim for running the firmware on a computer
+
+The firmware's Arduino, SD and HX711_ADC calls are backed by a simulated clock, an in-memory SD card
+and a load cell that reads whatever loadSource says. The firmware source itself is compiled unmodified
+(see Firmware.cpp).
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace Host {
+
+  extern uint64_t now_us;                             // Simulated time since power on
+  extern std::function<float(double)> loadSource;     // Force on the load cell in grams at a given time (seconds since power on)
+  extern std::function<void(int, int)> onDigitalWrite; // Called for every digitalWrite(pin, value)
+
+  extern float hx711Rate_sps;    // HX711 conversion rate (10 or 80 depending on the RATE pin)
+  extern int hx711Samples;       // HX711_ADC smoothing window (SAMPLES in the library's config.h)
+  extern uint32_t sdWriteCost_us; // Time charged to the clock for each println to a file open for writing
+  extern bool echoSerial;        // Print the firmware's Serial output to stderr
+
+  void Advance(uint64_t us);
+  void SerialInput(const std::string &text); // Queues characters for Serial.read()
+  std::string &SdFile(const std::string &name);
+  bool SdHasFile(const std::string &name);
+
+}
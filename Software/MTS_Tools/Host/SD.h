@@ -0,0 +1,43 @@
+// Host stand-in for the Arduino SD library, backed by an in-memory card (Host::SdFile)
+
+#pragma once
+
+#include <string>
+
+#include "Arduino.h"
+
+#define FILE_READ 0x01
+#define FILE_WRITE 0x06 // Write + append, like the real library
+#ifndef O_TRUNC
+#define O_TRUNC 0x40
+#endif
+
+class File {
+public:
+  File() {}
+  File(const std::string &name, int mode);
+
+  operator bool() const { return open_; }
+
+  void println(const String &s);
+  void print(const String &s);
+  String readString();
+  void flush() {}
+  void close() { open_ = false; }
+
+private:
+  std::string name_;
+  size_t position_ = 0;
+  bool writable_ = false;
+  bool open_ = false;
+};
+
+class SDClass {
+public:
+  bool begin(int chipSelect);
+  bool exists(const char *name);
+  File open(const char *name, int mode = FILE_READ) { return File(name, mode); }
+  File open(const String &name, int mode = FILE_READ) { return File(name.c_str(), mode); }
+};
+
+extern SDClass SD;
@@ -0,0 +1,2 @@
+// Host stand-in for SPI.h - the SD shim doesn't need a bus
+#pragma once
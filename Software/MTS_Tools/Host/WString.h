@@ -0,0 +1,41 @@
+// Host stand-in for Arduino's String. Constructors are implicit so expressions like 'TN ' + String(n) compile as they do on the board.
+
+#pragma once
+
+#include <string>
+
+class String {
+public:
+  String(const char *s = "") : s_(s ? s : "") {}
+  String(const std::string &s) : s_(s) {}
+  String(char c) : s_(1, c) {}
+  String(int v) : s_(std::to_string(v)) {}
+  String(unsigned int v) : s_(std::to_string(v)) {}
+  String(long v) : s_(std::to_string(v)) {}
+  String(unsigned long v) : s_(std::to_string(v)) {}
+  String(float v, unsigned int decimals = 2) : String((double) v, decimals) {}
+  String(double v, unsigned int decimals = 2);
+
+  unsigned int length() const { return (unsigned int) s_.size(); }
+  const char *c_str() const { return s_.c_str(); }
+  char operator[](unsigned int i) const { return i < s_.size() ? s_[i] : 0; }
+  char &operator[](unsigned int i);
+
+  String &operator+=(const String &rhs) { s_ += rhs.s_; return *this; }
+  String &operator+=(char c) { s_ += c; return *this; }
+
+  int indexOf(char c, unsigned int from = 0) const;
+  int indexOf(const String &s, unsigned int from = 0) const;
+  String substring(unsigned int begin) const { return substring(begin, length()); }
+  String substring(unsigned int begin, unsigned int end) const;
+  long toInt() const;
+  float toFloat() const;
+  void replace(const String &find, const String &replacement);
+
+  friend String operator+(const String &lhs, const String &rhs) { return String(lhs.s_ + rhs.s_); }
+  friend bool operator==(const String &lhs, const String &rhs) { return lhs.s_ == rhs.s_; }
+  friend bool operator!=(const String &lhs, const String &rhs) { return lhs.s_ != rhs.s_; }
+
+private:
+  std::string s_;
+};
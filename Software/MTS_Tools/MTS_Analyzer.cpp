@@ -0,0 +1,469 @@
+/*
+MTS_Analyzer - Batch analyzer for test stand data files (Linux host tool)
+
+This program is licenced under the Creative Commons Zero V1.0 Universal Licence
+
+- Memory-maps every .csv data file in a directory and parses them in parallel, one file per worker
+- Understands the header written by OpenDataFile() (columns are found by name, so reordering is fine)
+- Prints a comparison table and writes a RASP (.eng) thrust curve for every file with a burn in it
+
+Usage:
+  mts_analyzer <data dir> [-j threads] [-o eng output dir] [--csv summary.csv]
+  mts_analyzer --bench [corpus size MB (default 1024)] [-j max threads] [--bench-dir dir] [--keep]
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const float gramsToNewtons = 9.80665e-3f;
+const float burnThresholdFraction = 0.05f; // Burn time is measured between the first and last sample above 5% of peak thrust
+const float minimumPeak_g = 10;            // Same as the default motor load threshold (MLT) in config.txt
+
+struct Columns {
+  int state = -1;
+  int testTime = -1;
+  int load = -1;
+  int last = -1; // Highest column index we need, we stop splitting the row after it
+};
+
+struct TestResult {
+  std::string path;
+  std::string name;
+  bool ok = false;
+  const char *error = "";
+  size_t bytes = 0;
+  size_t samples = 0;
+  float peakThrust_N = 0;
+  float aveThrust_N = 0;
+  float impulse_Ns = 0;
+  float burnTime_s = 0;
+  float burnStart_s = 0;
+  char motorClass[16] = "-";
+};
+
+struct Options {
+  std::string dataDir;
+  std::string engDir; // Empty means next to the data file
+  std::string csvPath;
+  unsigned threads = 0;
+  bool writeEng = true;
+};
+
+//==PARSING==
+// Nothing in here allocates. Fields are read straight out of the mapped file.
+
+static bool ParseNumber(const char *p, const char *end, float &out) { // Parses the "-12.34" style numbers Arduino's String(float) produces
+  while (p < end && *p == ' ') p++;
+
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) { negative = *p == '-'; p++; }
+
+  uint64_t mantissa = 0;
+  int digits = 0, decimals = 0;
+  bool seenPoint = false;
+
+  for (; p < end; p++) {
+    char c = *p;
+    if (c >= '0' && c <= '9') {
+      if (digits < 18) { mantissa = mantissa * 10 + (c - '0'); digits++; if (seenPoint) decimals++; }
+      else if (!seenPoint) return false; // Too big to be anything we logged
+    } else if (c == '.' && !seenPoint) {
+      seenPoint = true;
+    } else {
+      break;
+    }
+  }
+
+  while (p < end && (*p == ' ' || *p == '\r')) p++;
+  if (digits == 0 || p != end) return false; // "nan", "ovf", "inf" and garbage all end up here
+
+  static const double powersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+                                        1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18 };
+  double value = (double) mantissa / powersOfTen[decimals];
+  out = (float) (negative ? -value : value);
+  return true;
+}
+
+static bool FieldIs(const char *p, const char *end, const char *name) {
+  while (p < end && *p == ' ') p++;
+  while (end > p && (end[-1] == ' ' || end[-1] == '\r')) end--;
+  size_t len = strlen(name);
+  return (size_t) (end - p) == len && memcmp(p, name, len) == 0;
+}
+
+static const char *ParseHeader(const char *p, const char *end, Columns &cols) { // Returns the start of the first data row
+  const char *lineEnd = (const char *) memchr(p, '\n', end - p);
+  if (!lineEnd) lineEnd = end;
+
+  const char *fieldStart = p;
+  for (int field = 0; fieldStart <= lineEnd; field++) {
+    const char *fieldEnd = (const char *) memchr(fieldStart, ',', lineEnd - fieldStart);
+    if (!fieldEnd) fieldEnd = lineEnd;
+
+    if (FieldIs(fieldStart, fieldEnd, "System_State")) cols.state = field;
+    else if (FieldIs(fieldStart, fieldEnd, "Test_Time_s")) cols.testTime = field;
+    else if (FieldIs(fieldStart, fieldEnd, "Load_Cell_Data_g")) cols.load = field;
+
+    fieldStart = fieldEnd + 1;
+  }
+
+  cols.last = std::max(cols.state, std::max(cols.testTime, cols.load));
+  return lineEnd < end ? lineEnd + 1 : end;
+}
+
+template <typename F>
+static size_t ForEachSample(const char *p, const char *end, const Columns &cols, F onSample) {
+  size_t samples = 0;
+
+  while (p < end) {
+    const char *lineEnd = (const char *) memchr(p, '\n', end - p);
+    if (!lineEnd) lineEnd = end;
+
+    float testTime = 0, load = 0, state = 0;
+    bool gotTime = false, gotLoad = false;
+
+    const char *fieldStart = p;
+    for (int field = 0; field <= cols.last && fieldStart <= lineEnd; field++) {
+      const char *fieldEnd = (const char *) memchr(fieldStart, ',', lineEnd - fieldStart);
+      if (!fieldEnd) fieldEnd = lineEnd;
+
+      if (field == cols.testTime) gotTime = ParseNumber(fieldStart, fieldEnd, testTime);
+      else if (field == cols.load) gotLoad = ParseNumber(fieldStart, fieldEnd, load);
+      else if (field == cols.state) ParseNumber(fieldStart, fieldEnd, state);
+
+      fieldStart = fieldEnd + 1;
+    }
+
+    // Rows cut short by a crash or power loss are simply skipped
+    if (gotTime && gotLoad) {
+      onSample(testTime, load, (int) state);
+      samples++;
+    }
+
+    p = lineEnd + 1;
+  }
+
+  return samples;
+}
+
+//==ANALYSIS==
+
+static void ClassifyMotor(float impulse_Ns, float aveThrust_N, char *out, size_t outSize) { // NAR letter class + average thrust, e.g. "C6"
+  const char *prefix;
+  char letter[2] = { 0, 0 };
+
+  if (impulse_Ns <= 0.3125f) prefix = "1/8A";
+  else if (impulse_Ns <= 0.625f) prefix = "1/4A";
+  else if (impulse_Ns <= 1.25f) prefix = "1/2A";
+  else {
+    int k = (int) std::ceil(std::log2(impulse_Ns / 2.5f));
+    letter[0] = (char) ('A' + std::min(std::max(k, 0), 25));
+    prefix = letter;
+  }
+
+  snprintf(out, outSize, "%s%d", prefix, (int) std::lround(aveThrust_N));
+}
+
+static void WriteEngFile(const TestResult &result, const Options &options, const char *data, const char *end, const Columns &cols) {
+  std::string engPath;
+  size_t slash = result.path.find_last_of('/');
+  std::string dir = options.engDir.empty() ? result.path.substr(0, slash == std::string::npos ? 0 : slash + 1) : options.engDir + "/";
+  size_t dot = result.name.find_last_of('.');
+  engPath = dir + result.name.substr(0, dot) + ".eng";
+
+  FILE *eng = fopen(engPath.c_str(), "w");
+  if (!eng) { fprintf(stderr, "! Could not write %s\n", engPath.c_str()); return; }
+
+  char buffer[1 << 16];
+  setvbuf(eng, buffer, _IOFBF, sizeof(buffer));
+
+  // RASP header: name diameter(mm) length(mm) delays propellant(kg) total(kg) manufacturer
+  // The stand doesn't know the physical motor, so those are left as 0 to be filled in by hand.
+  fprintf(eng, "; %s - %.2f Ns, %.2f s burn, generated by MTS_Analyzer from %s\n", result.motorClass, result.impulse_Ns, result.burnTime_s, result.name.c_str());
+  fprintf(eng, "; Diameter, length, delays and weights are unknown to the test stand - edit before use\n");
+  fprintf(eng, "%s 0 0 0 0.0 0.0 MTS\n", result.motorClass);
+
+  float burnEnd_s = result.burnStart_s + result.burnTime_s;
+  float lastTime = 0;
+  ForEachSample(data, end, cols, [&](float testTime, float load, int) {
+    float t = testTime - result.burnStart_s;
+    if (t <= lastTime || testTime > burnEnd_s) return; // RASP wants strictly increasing times after 0
+    fprintf(eng, "   %.3f %.3f\n", t, std::max(load, 0.0f) * gramsToNewtons);
+    lastTime = t;
+  });
+  fprintf(eng, "   %.3f 0.000\n;\n", lastTime + 0.01f);
+
+  fclose(eng);
+}
+
+static void AnalyzeFile(TestResult &result, const Options &options) {
+  int fd = open(result.path.c_str(), O_RDONLY);
+  if (fd < 0) { result.error = "could not open"; return; }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) { close(fd); result.error = "empty file"; return; }
+  result.bytes = (size_t) st.st_size;
+
+  void *map = mmap(nullptr, result.bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) { result.error = "mmap failed"; return; }
+  madvise(map, result.bytes, MADV_SEQUENTIAL);
+
+  const char *data = (const char *) map;
+  const char *end = data + result.bytes;
+
+  Columns cols;
+  const char *rows = ParseHeader(data, end, cols);
+
+  if (cols.testTime < 0 || cols.load < 0) {
+    result.error = "not a test stand data file";
+  } else {
+    // Pass 1 - peak thrust
+    float peak_g = 0;
+    result.samples = ForEachSample(rows, end, cols, [&](float, float load, int) { peak_g = std::max(peak_g, load); });
+
+    if (peak_g < minimumPeak_g) {
+      result.error = "no burn found";
+    } else {
+      // Pass 2 - burn window and impulse. We keep integrating past dips and only keep the impulse up to the last sample above threshold.
+      float threshold_g = peak_g * burnThresholdFraction;
+      bool started = false;
+      float prevTime = 0, prevLoad = 0, impulse_gs = 0, impulseAtLast_gs = 0, lastAbove_s = 0;
+
+      ForEachSample(rows, end, cols, [&](float testTime, float load, int) {
+        load = std::max(load, 0.0f);
+        if (!started) {
+          if (load < threshold_g) return;
+          started = true;
+          result.burnStart_s = testTime;
+        } else if (testTime > prevTime) {
+          impulse_gs += 0.5f * (load + prevLoad) * (testTime - prevTime);
+        }
+        if (load >= threshold_g) { lastAbove_s = testTime; impulseAtLast_gs = impulse_gs; }
+        prevTime = testTime;
+        prevLoad = load;
+      });
+
+      result.peakThrust_N = peak_g * gramsToNewtons;
+      result.impulse_Ns = impulseAtLast_gs * gramsToNewtons;
+      result.burnTime_s = lastAbove_s - result.burnStart_s;
+      result.aveThrust_N = result.burnTime_s > 0 ? result.impulse_Ns / result.burnTime_s : 0;
+      ClassifyMotor(result.impulse_Ns, result.aveThrust_N, result.motorClass, sizeof(result.motorClass));
+      result.ok = true;
+
+      if (options.writeEng) WriteEngFile(result, options, rows, end, cols);
+    }
+  }
+
+  munmap(map, result.bytes);
+}
+
+static void AnalyzeAll(std::vector<TestResult> &results, const Options &options, unsigned threads) { // Workers pull the next file off a shared counter
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    for (size_t i = next++; i < results.size(); i = next++) AnalyzeFile(results[i], options);
+  };
+
+  threads = std::max(1u, std::min<unsigned>(threads, (unsigned) results.size()));
+  std::vector<std::thread> pool;
+  for (unsigned i = 1; i < threads; i++) pool.emplace_back(worker);
+  worker();
+  for (std::thread &t : pool) t.join();
+}
+
+//==FILES==
+
+static bool EndsWithCsv(const char *name) {
+  size_t len = strlen(name);
+  return len > 4 && strcasecmp(name + len - 4, ".csv") == 0;
+}
+
+static long TrailingNumber(const std::string &name) { // "TEST0012.CSV" -> 12, sorts by test number even if the names aren't zero padded
+  size_t end = name.find_last_of("0123456789");
+  if (end == std::string::npos) return -1;
+  size_t begin = end;
+  while (begin > 0 && isdigit((unsigned char) name[begin - 1])) begin--;
+  return strtol(name.c_str() + begin, nullptr, 10);
+}
+
+static std::vector<TestResult> FindDataFiles(const std::string &dir) {
+  std::vector<TestResult> results;
+  DIR *d = opendir(dir.c_str());
+  if (!d) return results;
+
+  while (dirent *entry = readdir(d)) {
+    if (!EndsWithCsv(entry->d_name)) continue;
+    TestResult result;
+    result.name = entry->d_name;
+    result.path = dir + "/" + entry->d_name;
+    results.push_back(result);
+  }
+  closedir(d);
+
+  std::sort(results.begin(), results.end(), [](const TestResult &a, const TestResult &b) {
+    long na = TrailingNumber(a.name), nb = TrailingNumber(b.name);
+    return na != nb ? na < nb : a.name < b.name;
+  });
+  return results;
+}
+
+static void PrintTable(const std::vector<TestResult> &results, FILE *out) {
+  fprintf(out, "%-24s %9s %8s %8s %11s %8s %8s %7s\n", "File", "Samples", "Class", "Burn_s", "Impulse_Ns", "Peak_N", "Ave_N", "Start_s");
+  for (const TestResult &r : results) {
+    if (!r.ok) { fprintf(out, "%-24s %9zu   (%s)\n", r.name.c_str(), r.samples, r.error); continue; }
+    fprintf(out, "%-24s %9zu %8s %8.2f %11.2f %8.2f %8.2f %7.2f\n", r.name.c_str(), r.samples, r.motorClass,
+            r.burnTime_s, r.impulse_Ns, r.peakThrust_N, r.aveThrust_N, r.burnStart_s);
+  }
+}
+
+static void WriteSummaryCsv(const std::vector<TestResult> &results, const std::string &path) {
+  FILE *out = fopen(path.c_str(), "w");
+  if (!out) { fprintf(stderr, "! Could not write %s\n", path.c_str()); return; }
+  fprintf(out, "File, Samples, Motor_Class, Burn_Time_s, Total_Impulse_Ns, Peak_Thrust_N, Average_Thrust_N, Burn_Start_s, Error\n");
+  for (const TestResult &r : results) {
+    fprintf(out, "%s, %zu, %s, %.3f, %.3f, %.3f, %.3f, %.3f, %s\n", r.name.c_str(), r.samples, r.motorClass,
+            r.burnTime_s, r.impulse_Ns, r.peakThrust_N, r.aveThrust_N, r.burnStart_s, r.error);
+  }
+  fclose(out);
+}
+
+//==BENCHMARK==
+
+static std::string MakeSyntheticTest(size_t targetBytes) { // A 30 s countdown followed by a C6-ish burn, padded with standby data to the target size
+  std::string file = "System_State, System_On_Time_s, Test_Time_s, Load_Cell_Data_g, Load_Cell_Data_Ave_g, Calibration_State, Data_Log_Interval_ms, Data_Log_Rate_Hz, Loop_Run_Time_micros, Available_Memory_b\n";
+  char row[160];
+  uint32_t noise = 12345;
+
+  for (long i = 0; file.size() < targetBytes; i++) {
+    float testTime = -30.0f + i * 0.011f;
+    float load = 0;
+    int state = testTime < 0 ? 1 : 3;
+    if (testTime >= 0 && testTime < 0.2f) load = 2500 * testTime;
+    else if (testTime >= 0.2f && testTime < 0.4f) load = 500 - 1600 * (testTime - 0.2f);
+    else if (testTime >= 0.4f && testTime < 1.8f) load = 170;
+    noise = noise * 1664525u + 1013904223u;
+    load += ((noise >> 16) % 200) / 100.0f - 1.0f;
+    if (testTime >= 1.8f) state = 5;
+
+    int len = snprintf(row, sizeof(row), "%d, %ld, %.2f, %.2f, %.2f, -1, 10, 100, %lu, %d\n",
+                       state, 12 + i / 90, testTime, load, load, 4000ul + noise % 500, 2000 + (int) (noise % 64));
+    file.append(row, len);
+  }
+  return file;
+}
+
+static int RunBenchmark(size_t corpus_MB, unsigned maxThreads, std::string dir, bool keep) {
+  const size_t fileBytes = 4u << 20;
+  size_t fileCount = std::max<size_t>(1, (corpus_MB << 20) / fileBytes);
+
+  char tmpl[] = "/tmp/mts_bench_XXXXXX";
+  if (dir.empty()) {
+    if (!mkdtemp(tmpl)) { perror("mkdtemp"); return 1; }
+    dir = tmpl;
+  } else {
+    mkdir(dir.c_str(), 0755);
+  }
+
+  printf("Writing %zu x %zu MB synthetic data files to %s...\n", fileCount, fileBytes >> 20, dir.c_str());
+  std::string content = MakeSyntheticTest(fileBytes);
+  std::vector<TestResult> files;
+  for (size_t i = 0; i < fileCount; i++) {
+    TestResult result;
+    char name[32];
+    snprintf(name, sizeof(name), "TEST%04zu.CSV", i + 1); // Named like the firmware names them
+    result.name = name;
+    result.path = dir + "/" + result.name;
+    FILE *f = fopen(result.path.c_str(), "w");
+    if (!f || fwrite(content.data(), 1, content.size(), f) != content.size()) { perror(result.path.c_str()); return 1; }
+    fclose(f);
+    files.push_back(result);
+  }
+
+  Options options;
+  options.writeEng = false;
+  double totalMB = (double) (fileCount * content.size()) / (1 << 20);
+
+  std::vector<unsigned> threadCounts;
+  for (unsigned t = 1; t < maxThreads; t *= 2) threadCounts.push_back(t);
+  threadCounts.push_back(maxThreads);
+
+  { std::vector<TestResult> warmUp = files; AnalyzeAll(warmUp, options, maxThreads); } // Gets the corpus into the page cache
+
+  double baseline = 0;
+  printf("%8s %10s %10s %8s\n", "Threads", "Time_s", "MB/s", "Speedup");
+  for (unsigned threads : threadCounts) {
+    std::vector<TestResult> results = files;
+    auto start = std::chrono::steady_clock::now();
+    AnalyzeAll(results, options, threads);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (const TestResult &r : results) {
+      if (!r.ok) { fprintf(stderr, "! %s: %s\n", r.name.c_str(), r.error); return 1; }
+    }
+
+    double throughput = totalMB / seconds;
+    if (baseline == 0) baseline = throughput;
+    printf("%8u %10.3f %10.1f %7.2fx\n", threads, seconds, throughput, throughput / baseline);
+  }
+
+  if (!keep) {
+    for (const TestResult &f : files) unlink(f.path.c_str());
+    rmdir(dir.c_str());
+  }
+  return 0;
+}
+
+//==MAIN==
+
+static void PrintUsage() {
+  fprintf(stderr, "Usage: mts_analyzer <data dir> [-j threads] [-o eng output dir] [--csv summary.csv]\n");
+  fprintf(stderr, "       mts_analyzer --bench [size MB] [-j max threads] [--bench-dir dir] [--keep]\n");
+}
+
+int main(int argc, char **argv) {
+  Options options;
+  options.threads = std::max(1u, std::thread::hardware_concurrency());
+  bool bench = false, keep = false;
+  size_t corpus_MB = 1024;
+  std::string benchDir;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "-j" && i + 1 < argc) options.threads = std::max(1, atoi(argv[++i]));
+    else if (arg == "-o" && i + 1 < argc) options.engDir = argv[++i];
+    else if (arg == "--csv" && i + 1 < argc) options.csvPath = argv[++i];
+    else if (arg == "--bench") { bench = true; if (i + 1 < argc && isdigit((unsigned char) argv[i + 1][0])) corpus_MB = strtoul(argv[++i], nullptr, 10); }
+    else if (arg == "--bench-dir" && i + 1 < argc) benchDir = argv[++i];
+    else if (arg == "--keep") keep = true;
+    else if (arg[0] != '-' && options.dataDir.empty()) options.dataDir = arg;
+    else { PrintUsage(); return 1; }
+  }
+
+  if (bench) return RunBenchmark(corpus_MB, options.threads, benchDir, keep);
+  if (options.dataDir.empty()) { PrintUsage(); return 1; }
+
+  std::vector<TestResult> results = FindDataFiles(options.dataDir);
+  if (results.empty()) { fprintf(stderr, "No .csv data files found in %s\n", options.dataDir.c_str()); return 1; }
+
+  AnalyzeAll(results, options, options.threads);
+
+  PrintTable(results, stdout);
+  if (!options.csvPath.empty()) WriteSummaryCsv(results, options.csvPath);
+
+  return 0;
+}
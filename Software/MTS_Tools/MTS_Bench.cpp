@@ -0,0 +1,215 @@
+/*
+MTS_Bench - Microbenchmarks for the firmware's hot functions (Linux host tool)
+
+This program is licenced under the Creative Commons Zero V1.0 Universal Licence
+
+- Runs WriteDataToSD(), MovingLoadAve(), availableMemory(), ProcessVariableLine() and TimeKeeper() from the
+  unmodified firmware (through the host shim in Host/) in isolation, after booting it with setup()
+- Each sample is a batch of calls timed with steady_clock, after some warm-up batches. We report min, median,
+  mean and max per call. Use the median when comparing, it's the least noisy.
+- availableMemory() on the host is a single malloc/free, the first 6 KB request always fits. On the board it
+  decrements the size until malloc succeeds, so it costs roughly one malloc per byte in use - only the
+  on-target numbers mean anything for it.
+- Results can be saved as CSV and compared with an earlier run. The on-target build (env:nano_every_bench)
+  prints the same CSV in CPU cycles over Serial, so those can be compared the same way.
+
+Usage:
+  mts_bench [--samples n] [--batch n] [--csv results.csv] [--compare baseline.csv] [--threshold percent]
+  mts_bench --compare baseline.csv results.csv [--threshold percent]   Compares two saved runs (host or on-target)
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sched.h>
+
+#include "Host/Host.h"
+#include "Host/Arduino.h"
+#include "Host/SD.h"
+
+// Firmware functions and state (src/main.cpp)
+void setup();
+void WriteDataToSD();
+float MovingLoadAve(float value, bool reset = false);
+int availableMemory();
+void ProcessVariableLine(String line);
+void TimeKeeper();
+extern String dataFileName;
+extern unsigned long sdTime;
+extern float currentCellData;
+extern float dataSafeLength_s;
+
+struct BenchResult {
+  std::string name;
+  std::string unit;
+  int samples = 0;
+  double min = 0, median = 0, mean = 0, max = 0;
+};
+
+struct Settings {
+  int samples = 31;
+  int warmUpSamples = 3;
+  int batch = 10000;
+};
+
+volatile float benchSink; // Stops the compiler throwing away results we don't otherwise use
+
+template <typename F>
+static BenchResult Measure(const char *name, const Settings &settings, F function) {
+  std::vector<double> perCall;
+
+  for (int s = 0; s < settings.warmUpSamples + settings.samples; s++) {
+    Host::SdFile(dataFileName.c_str()).clear(); // Keeps the simulated card from growing, outside the timed part
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < settings.batch; i++) function();
+    double elapsed_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    if (s >= settings.warmUpSamples) perCall.push_back(elapsed_ns / settings.batch);
+  }
+
+  std::sort(perCall.begin(), perCall.end());
+  BenchResult result;
+  result.name = name;
+  result.unit = "ns";
+  result.samples = (int) perCall.size();
+  result.min = perCall.front();
+  result.median = perCall[perCall.size() / 2];
+  result.max = perCall.back();
+  for (double v : perCall) result.mean += v / perCall.size();
+  return result;
+}
+
+static void PinToOneCore() { // Keeps the scheduler from moving us between cores mid-sample
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(sched_getcpu(), &set);
+  sched_setaffinity(0, sizeof(set), &set);
+}
+
+static std::vector<BenchResult> RunBenchmarks(const Settings &settings) {
+  Host::sdWriteCost_us = 0;
+  Host::SdFile("config.txt") = "*MLT: 10;\n*CL: 30;\n*LCV: 0;\n*DSL: 5;\n*DLF: 10;\n*DLS: 100;\n*BS: 1;\n*TN: 0;\n";
+  Host::SerialInput("l");
+  setup();
+
+  String configLine = "*DSL: " + String(dataSafeLength_s) + ";"; // Sets DSL to what it already is
+
+  std::vector<BenchResult> results;
+  results.push_back(Measure("WriteDataToSD", settings, [] { sdTime = 0; WriteDataToSD(); }));
+  results.push_back(Measure("MovingLoadAve", settings, [] { benchSink = MovingLoadAve(currentCellData); }));
+  results.push_back(Measure("availableMemory", settings, [] { benchSink = availableMemory(); }));
+  results.push_back(Measure("ProcessVariableLine", settings, [&] { ProcessVariableLine(configLine); }));
+  results.push_back(Measure("TimeKeeper", settings, [] { TimeKeeper(); }));
+  return results;
+}
+
+//==RESULTS==
+
+static void PrintResults(const std::vector<BenchResult> &results, FILE *out, bool csv) {
+  if (csv) fprintf(out, "Function, Unit, Samples, Min, Median, Mean, Max\n");
+  else fprintf(out, "%-20s %6s %8s %12s %12s %12s %12s\n", "Function", "Unit", "Samples", "Min", "Median", "Mean", "Max");
+
+  for (const BenchResult &r : results) {
+    if (csv) fprintf(out, "%s, %s, %d, %.1f, %.1f, %.1f, %.1f\n", r.name.c_str(), r.unit.c_str(), r.samples, r.min, r.median, r.mean, r.max);
+    else fprintf(out, "%-20s %6s %8d %12.1f %12.1f %12.1f %12.1f\n", r.name.c_str(), r.unit.c_str(), r.samples, r.min, r.median, r.mean, r.max);
+  }
+}
+
+static bool LoadResults(const std::string &path, std::vector<BenchResult> &results) { // Skips anything that isn't a result row, so a raw Serial log works too
+  std::ifstream in(path);
+  if (!in) return false;
+
+  for (std::string line; std::getline(in, line);) {
+    std::vector<std::string> fields;
+    std::stringstream row(line);
+    for (std::string field; std::getline(row, field, ',');) {
+      field.erase(0, field.find_first_not_of(' '));
+      field.erase(field.find_last_not_of(" \r") + 1);
+      fields.push_back(field);
+    }
+    if (fields.size() != 7 || fields[0] == "Function") continue;
+
+    BenchResult r;
+    r.name = fields[0];
+    r.unit = fields[1];
+    r.samples = atoi(fields[2].c_str());
+    r.min = atof(fields[3].c_str());
+    r.median = atof(fields[4].c_str());
+    r.mean = atof(fields[5].c_str());
+    r.max = atof(fields[6].c_str());
+    results.push_back(r);
+  }
+  return !results.empty();
+}
+
+static int Compare(const std::vector<BenchResult> &baseline, const std::vector<BenchResult> &current, double threshold_pct) { // Returns the number of regressions
+  std::map<std::string, BenchResult> before;
+  for (const BenchResult &r : baseline) before[r.name] = r;
+
+  int regressions = 0;
+  printf("\n%-20s %6s %12s %12s %9s\n", "Function", "Unit", "Baseline", "Current", "Change");
+  for (const BenchResult &r : current) {
+    auto it = before.find(r.name);
+    if (it == before.end() || it->second.unit != r.unit) { printf("%-20s %6s %12s %12.1f %9s\n", r.name.c_str(), r.unit.c_str(), "-", r.median, "new"); continue; }
+
+    double change_pct = it->second.median > 0 ? (r.median / it->second.median - 1) * 100 : 0;
+    bool regressed = change_pct > threshold_pct;
+    if (regressed) regressions++;
+    printf("%-20s %6s %12.1f %12.1f %+8.1f%%%s\n", r.name.c_str(), r.unit.c_str(), it->second.median, r.median, change_pct, regressed ? "  SLOWER" : "");
+  }
+  return regressions;
+}
+
+static void PrintUsage() {
+  fprintf(stderr, "Usage: mts_bench [--samples n] [--batch n] [--csv results.csv] [--compare baseline.csv] [--threshold percent]\n");
+  fprintf(stderr, "       mts_bench --compare baseline.csv results.csv [--threshold percent]\n");
+}
+
+int main(int argc, char **argv) {
+  Settings settings;
+  std::string csvPath, baselinePath, resultsPath;
+  double threshold_pct = 10;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--samples" && hasValue) settings.samples = std::max(1, atoi(argv[++i]));
+    else if (arg == "--batch" && hasValue) settings.batch = std::max(1, atoi(argv[++i]));
+    else if (arg == "--csv" && hasValue) csvPath = argv[++i];
+    else if (arg == "--compare" && hasValue) baselinePath = argv[++i];
+    else if (arg == "--threshold" && hasValue) threshold_pct = atof(argv[++i]);
+    else if (arg[0] != '-' && resultsPath.empty()) resultsPath = arg;
+    else { PrintUsage(); return 1; }
+  }
+
+  std::vector<BenchResult> baseline, results;
+  if (!baselinePath.empty() && !LoadResults(baselinePath, baseline)) { fprintf(stderr, "! No results in %s\n", baselinePath.c_str()); return 1; }
+
+  if (!resultsPath.empty()) {
+    if (baselinePath.empty()) { PrintUsage(); return 1; }
+    if (!LoadResults(resultsPath, results)) { fprintf(stderr, "! No results in %s\n", resultsPath.c_str()); return 1; }
+  } else {
+    PinToOneCore();
+    results = RunBenchmarks(settings);
+  }
+
+  PrintResults(results, stdout, false);
+
+  if (!csvPath.empty()) {
+    FILE *out = fopen(csvPath.c_str(), "w");
+    if (!out) { fprintf(stderr, "! Could not write %s\n", csvPath.c_str()); return 1; }
+    PrintResults(results, out, true);
+    fclose(out);
+  }
+
+  if (!baseline.empty()) return Compare(baseline, results, threshold_pct) ? 1 : 0;
+  return 0;
+}
@@ -0,0 +1,422 @@
+/*
+MTS_Replay - Replays thrust traces through the firmware's state machine (Linux host tool)
+
+This program is licenced under the Creative Commons Zero V1.0 Universal Licence
+
+- The firmware (src/main.cpp) is compiled unmodified against the host shim in Host/, so setup() and loop()
+  run the same logic as on the board, just against a simulated clock, SD card and load cell
+- Type sizes are the host's, not the AVR's: on x86-64 unsigned long is 64 bit and int is 32 bit, so the
+  millis()/micros() wrap (~49 days/~71 min) and 16-bit int overflow don't happen here. `make M32=1` builds
+  32 bit (needs gcc-multilib) so unsigned long and the clock wrap like on the board; int stays 32 bit
+- Each trace is run in its own process so the firmware's globals and statics start fresh every time
+- For every trace we measure ignition and burnout detection latency, state regressions (4 -> 3) and
+  how much of the burn was logged, and flag anything outside its budget
+
+Usage:
+  mts_replay [options]                  Runs the built in corpus (real burns from Traces/ plus synthetic ones)
+  mts_replay [options] <trace.csv> ...  Runs your own traces, either "Time_s, Thrust_g" or a TESTnnnn.CSV from the card
+
+Options:
+  --traces <dir>          Where C6-5.csv and E6.csv live (default: Traces)
+  --config <config.txt>   Config file to put on the simulated card (default: a copy of SD-Card-Files/config.txt)
+  --loop-us <us>          Time one loop() takes, not counting SD writes (default: 2000)
+  --sd-us <us>            Time one SD println takes (default: 3000)
+  --sps <rate>            HX711 conversion rate (default: 80)
+  --tests <n>             Fires each trace n times in one boot, re-arming with 'R' in between (default: 1).
+                          Every column is the worst single test, so the budgets stay per test.
+  --ignition-budget <ms>, --burnout-budget <ms>, --max-regressions <n>, --min-coverage <0-1>
+                          Budgets used for traces given on the command line
+  -v                      Print the firmware's Serial output
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Host/Host.h"
+#include "Host/Arduino.h"
+
+// Firmware entry points and state (src/main.cpp)
+void setup();
+void loop();
+extern int systemState;
+extern float motorLoadThreshold;
+extern int dataLogIntervalFast_ms;
+extern String dataFileName;
+
+const int pyroPin = 4; // ignitionPyroPin in main.cpp
+
+const char *defaultConfig =
+  "Motor Load Threshold (grams) (How much force motor must produce to be considered \"on\"):\n*MLT: 10;\n\n"
+  "Countdown Length (Seconds):\n*CL: 30;\n\n"
+  "Loadcell Calibration Value (Float):\n*LCV: 0;\n\n"
+  "Data Safe Length (Seconds):\n*DSL: 5;\n\n"
+  "Data Log Interval (Milliseconds):\nFast (Rate During Ignition and Burn)\n*DLF: 10;\nSlow (Rate During Countdown)\n*DLS: 100;\n\n"
+  "Buzzer On/Off (1/0):\n*BS: 1;\n\n"
+  "Test Number:\n*TN: 0;\n";
+
+struct Budget {
+  float ignitionLatency_ms = 250;
+  float burnoutLatency_ms = 600;
+  int maxRegressions = 0;
+  float minBurnCoverage = 0.6f; // Fraction of the rows we should have logged at the fast log rate during the burn
+};
+
+struct ReplayCase {
+  std::string name;
+  std::function<float(double)> thrust; // Grams vs seconds since the pyro fired, what the motor really does
+  double duration_s = 0;
+  float noise_g = 0;                   // Load cell noise added on top, doesn't count towards the true ignition/burnout times
+  Budget budget;
+};
+
+struct ReplayResult {
+  bool finished = false;       // Reached state 5
+  bool falseIgnition = false;  // State 3 before the motor actually produced MLT
+  bool earlyEnd = false;       // State 5 before true burnout - data lost
+  float ignitionLatency_ms = NAN;
+  float burnoutLatency_ms = NAN;
+  int regressions = 0;
+  long samplesLogged = 0;
+  long samplesInBurn = 0;
+  float burnCoverage = 0;
+};
+
+struct Settings {
+  std::string config = defaultConfig;
+  uint32_t loop_us = 2000;
+  uint32_t sd_us = 3000;
+  float sps = 80;
+  int tests = 1;
+  bool verbose = false;
+};
+
+//==TRACES==
+
+struct PointTrace { // Piecewise linear thrust curve
+  std::vector<std::pair<double, float>> points;
+
+  float operator()(double t) const {
+    if (points.empty()) return 0;
+    if (t <= points.front().first) return points.front().second;
+    if (t >= points.back().first) return points.back().second;
+    auto it = std::lower_bound(points.begin(), points.end(), t, [](const std::pair<double, float> &p, double v) { return p.first < v; });
+    auto prev = it - 1;
+    double f = (t - prev->first) / (it->first - prev->first);
+    return (float) (prev->second + f * (it->second - prev->second));
+  }
+};
+
+static bool LoadTrace(const std::string &path, PointTrace &trace) { // "Time_s, Thrust_g" or a firmware data file (Test_Time_s, Load_Cell_Data_g)
+  std::ifstream in(path);
+  std::string line;
+  if (!in || !std::getline(in, line)) return false;
+
+  int timeCol = 0, loadCol = 1, col = 0;
+  std::stringstream header(line);
+  for (std::string name; std::getline(header, name, ','); col++) {
+    name.erase(0, name.find_first_not_of(' '));
+    name.erase(name.find_last_not_of(" \r") + 1);
+    if (name == "Test_Time_s") timeCol = col;
+    if (name == "Load_Cell_Data_g") loadCol = col;
+  }
+
+  while (std::getline(in, line)) {
+    std::vector<double> fields;
+    std::stringstream row(line);
+    for (std::string field; std::getline(row, field, ',');) fields.push_back(atof(field.c_str()));
+    if ((int) fields.size() <= std::max(timeCol, loadCol) || fields[timeCol] < 0) continue; // Countdown rows aren't part of the trace
+    if (!trace.points.empty() && fields[timeCol] <= trace.points.back().first) continue;
+    trace.points.push_back({ fields[timeCol], (float) fields[loadCol] });
+  }
+  return trace.points.size() > 1;
+}
+
+static float Noise(double t, float sigma_g) { // Deterministic so a trace replays the same every time
+  if (sigma_g == 0) return 0;
+  uint32_t h = (uint32_t) (int64_t) std::llround(t * 1e5) * 2654435761u;
+  float sum = 0;
+  for (int i = 0; i < 4; i++) { h ^= h >> 15; h *= 2246822519u; h ^= h >> 13; sum += (h & 0xffff) / 65535.0f - 0.5f; }
+  float n = sum * sigma_g * 1.732f; // Sum of 4 uniforms has a std dev of 1/sqrt(3)
+  if ((h >> 16) % 97 == 0) n += 6 * sigma_g; // The odd spike
+  return n;
+}
+
+static std::vector<ReplayCase> BuiltInCorpus(const std::string &traceDir) {
+  std::vector<ReplayCase> corpus;
+
+  PointTrace c6, e6;
+  if (!LoadTrace(traceDir + "/C6-5.csv", c6) || !LoadTrace(traceDir + "/E6.csv", e6)) {
+    fprintf(stderr, "! Could not load C6-5.csv and E6.csv from %s (use --traces)\n", traceDir.c_str());
+    exit(1);
+  }
+
+  // Budgets are what the firmware does today plus some headroom. If one of these starts failing, something got slower.
+  ReplayCase c;
+
+  c = ReplayCase(); c.name = "C6-5"; c.thrust = c6; c.duration_s = c6.points.back().first;
+  c.budget.ignitionLatency_ms = 200; c.budget.burnoutLatency_ms = 400;
+  corpus.push_back(c);
+
+  c = ReplayCase(); c.name = "E6"; c.thrust = e6; c.duration_s = e6.points.back().first;
+  c.budget.ignitionLatency_ms = 200; c.budget.burnoutLatency_ms = 400;
+  corpus.push_back(c);
+
+  c = ReplayCase(); c.name = "C6-5 noisy"; c.thrust = c6; c.duration_s = c6.points.back().first; c.noise_g = 8;
+  c.budget.ignitionLatency_ms = 200; c.budget.burnoutLatency_ms = 400;
+  corpus.push_back(c);
+
+  c = ReplayCase(); c.name = "Chuffing"; c.duration_s = 3.5;
+  c.thrust = [](double t) { return (t > 0.2 && t < 2.6 && fmod(t - 0.2, 0.4) < 0.15) ? 300.0f : 0.0f; }; // 6 chuffs, 150 ms on, 250 ms off
+  c.budget.ignitionLatency_ms = 200; c.budget.burnoutLatency_ms = 800; c.budget.maxRegressions = 6; c.budget.minBurnCoverage = 0.5f;
+  corpus.push_back(c);
+
+  c = ReplayCase(); c.name = "Mid-burn dip"; c.duration_s = 3;
+  c.thrust = [](double t) { return t < 0.1 ? (float) (4000 * t) : t < 1.0 ? 400.0f : t < 1.6 ? 0.0f : t < 2.2 ? 300.0f : 0.0f; }; // Flames out for 600 ms, then relights
+  c.budget.ignitionLatency_ms = 200; c.budget.burnoutLatency_ms = 400; c.budget.maxRegressions = 2; // Bounces back to 4 once while the moving average refills
+  corpus.push_back(c);
+
+  c = ReplayCase(); c.name = "Slow start"; c.duration_s = 5;
+  c.thrust = [](double t) { return t < 0.3 ? 0.0f : t < 1.8 ? (float) (170 * (t - 0.3) / 1.5) : t < 3.8 ? 170.0f : t < 3.9 ? (float) (170 * (3.9 - t) / 0.1) : 0.0f; };
+  c.budget.ignitionLatency_ms = 250; c.budget.burnoutLatency_ms = 400;
+  corpus.push_back(c);
+
+  c = ReplayCase(); c.name = "Hang-fire"; c.duration_s = c6.points.back().first + 2.5;
+  c.thrust = [c6](double t) { return c6(t - 2.5); }; // Igniter takes 2.5 s to light the motor
+  c.budget.ignitionLatency_ms = 200; c.budget.burnoutLatency_ms = 400;
+  corpus.push_back(c);
+
+  c = ReplayCase(); c.name = "Early burnout"; c.duration_s = 2;
+  c.thrust = [c6](double t) { return t < 0.8 ? c6(t) : t < 0.85 ? (float) (c6(0.8) * (0.85 - t) / 0.05) : 0.0f; }; // Casing lets go after the peak
+  c.budget.ignitionLatency_ms = 200; c.budget.burnoutLatency_ms = 400;
+  corpus.push_back(c);
+
+  return corpus;
+}
+
+//==SIMULATION==
+
+static double pyroFired_s = -1;
+
+static ReplayResult ReplayTest(const ReplayCase &c, const Settings &settings) { // One countdown, burn and data safe period, from standby to state 5
+  ReplayResult result;
+
+  Host::SerialInput("S"); // Start countdown
+
+  // The true ignition and burnout times, from the motor's thrust rather than what the load cell saw
+  double trueIgnition_s = -1, trueBurnout_s = -1;
+  for (double t = 0; t <= c.duration_s; t += 0.001) {
+    if (c.thrust(t) > motorLoadThreshold) { if (trueIgnition_s < 0) trueIgnition_s = t; trueBurnout_s = t; }
+  }
+
+  double enteredBurn_s = -1, enteredDataSafe_s = -1, enteredEnd_s = -1;
+  double timeLimit_s = Host::now_us / 1e6 + 120 + c.duration_s;
+  int previousState = systemState;
+
+  while (systemState != 5 && Host::now_us / 1e6 < timeLimit_s) {
+    loop();
+    Host::Advance(settings.loop_us);
+
+    double now_s = Host::now_us / 1e6;
+    if (systemState == previousState) continue;
+    if (systemState < previousState) result.regressions++;
+    if (systemState == 3 && enteredBurn_s < 0) enteredBurn_s = now_s;
+    if (systemState == 4) enteredDataSafe_s = now_s;
+    if (systemState == 5) enteredEnd_s = now_s;
+    previousState = systemState;
+  }
+
+  result.finished = systemState == 5;
+
+  if (trueIgnition_s >= 0 && pyroFired_s >= 0) {
+    if (enteredBurn_s >= 0) {
+      result.ignitionLatency_ms = (float) ((enteredBurn_s - (pyroFired_s + trueIgnition_s)) * 1000);
+      result.falseIgnition = result.ignitionLatency_ms < 0;
+    }
+    if (enteredDataSafe_s >= 0) result.burnoutLatency_ms = (float) ((enteredDataSafe_s - (pyroFired_s + trueBurnout_s)) * 1000);
+    if (enteredEnd_s >= 0) result.earlyEnd = enteredEnd_s < pyroFired_s + trueBurnout_s;
+  }
+
+  // Count what made it onto the card. Test_Time_s is 0 when the countdown ends, which is when the pyro fires.
+  std::stringstream data(Host::SdFile(dataFileName.c_str()));
+  std::string line;
+  std::getline(data, line); // Header
+  while (std::getline(data, line)) {
+    std::vector<double> fields;
+    std::stringstream row(line);
+    for (std::string field; std::getline(row, field, ',');) fields.push_back(atof(field.c_str()));
+    if (fields.size() < 3) continue;
+    result.samplesLogged++;
+    if (fields[2] >= trueIgnition_s && fields[2] <= trueBurnout_s) result.samplesInBurn++;
+  }
+
+  double expected = (trueBurnout_s - trueIgnition_s) * 1000.0 / std::max(dataLogIntervalFast_ms, 1);
+  result.burnCoverage = expected > 0 ? (float) (result.samplesInBurn / expected) : 0;
+
+  return result;
+}
+
+static float Worst(float a, float b) { return std::isnan(a) || std::isnan(b) ? NAN : std::max(a, b); } // NaN means never detected
+
+static ReplayResult Simulate(const ReplayCase &c, const Settings &settings) { // Boots the firmware, then replays the trace once per test, re-arming with 'R' in between
+  Host::sdWriteCost_us = settings.sd_us;
+  Host::hx711Rate_sps = settings.sps;
+  Host::echoSerial = settings.verbose;
+  Host::SdFile("config.txt") = settings.config;
+
+  Host::onDigitalWrite = [](int pin, int value) {
+    if (pin == pyroPin && value == HIGH && pyroFired_s < 0) pyroFired_s = Host::now_us / 1e6;
+  };
+  Host::loadSource = [&c](double t) {
+    float load = pyroFired_s < 0 ? 0 : c.thrust(t - pyroFired_s);
+    return load + Noise(t, c.noise_g);
+  };
+
+  Host::SerialInput("l"); // Load calibration value from config
+  setup();
+
+  ReplayResult worst;
+  for (int test = 0; test < settings.tests; test++) {
+    if (test > 0) {
+      pyroFired_s = -1; // New motor on the stand
+      Host::SerialInput("R");
+      loop();
+      Host::Advance(settings.loop_us);
+    }
+
+    ReplayResult r = ReplayTest(c, settings);
+
+    if (test == 0) { worst = r; continue; }
+
+    // Keep the worst of each measurement across tests
+    worst.finished = worst.finished && r.finished;
+    worst.falseIgnition |= r.falseIgnition;
+    worst.earlyEnd |= r.earlyEnd;
+    worst.ignitionLatency_ms = Worst(worst.ignitionLatency_ms, r.ignitionLatency_ms);
+    worst.burnoutLatency_ms = Worst(worst.burnoutLatency_ms, r.burnoutLatency_ms);
+    worst.regressions = std::max(worst.regressions, r.regressions);
+    worst.samplesLogged = std::min(worst.samplesLogged, r.samplesLogged);
+    worst.samplesInBurn = std::min(worst.samplesInBurn, r.samplesInBurn);
+    worst.burnCoverage = std::min(worst.burnCoverage, r.burnCoverage);
+  }
+  return worst;
+}
+
+static bool RunCase(const ReplayCase &c, const Settings &settings, ReplayResult &result) { // Forks so every run gets a freshly booted firmware
+  int fds[2];
+  if (pipe(fds) != 0) { perror("pipe"); return false; }
+
+  pid_t pid = fork();
+  if (pid < 0) { perror("fork"); return false; }
+
+  if (pid == 0) {
+    close(fds[0]);
+    ReplayResult childResult = Simulate(c, settings);
+    ssize_t written = write(fds[1], &childResult, sizeof(childResult));
+    _exit(written == (ssize_t) sizeof(childResult) ? 0 : 1);
+  }
+
+  close(fds[1]);
+  ssize_t got = read(fds[0], &result, sizeof(result));
+  close(fds[0]);
+
+  int status = 0;
+  waitpid(pid, &status, 0);
+  return got == (ssize_t) sizeof(result) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+//==REPORT==
+
+static bool Check(const ReplayResult &r, const Budget &b, std::string &why) {
+  if (!r.finished) why += "never reached state 5; ";
+  if (r.falseIgnition) why += "ignition detected before motor lit; ";
+  if (r.earlyEnd) why += "ended before burnout; ";
+  if (!(r.ignitionLatency_ms <= b.ignitionLatency_ms)) why += "ignition latency; ";
+  if (!(r.burnoutLatency_ms <= b.burnoutLatency_ms)) why += "burnout latency; ";
+  if (r.regressions > b.maxRegressions) why += "state regressions; ";
+  if (r.burnCoverage < b.minBurnCoverage) why += "burn samples logged; ";
+  return why.empty();
+}
+
+static void PrintUsage() {
+  fprintf(stderr, "Usage: mts_replay [--traces dir] [--config config.txt] [--loop-us us] [--sd-us us] [--sps rate] [--tests n] [-v]\n");
+  fprintf(stderr, "                  [--ignition-budget ms] [--burnout-budget ms] [--max-regressions n] [--min-coverage f] [trace.csv ...]\n");
+}
+
+int main(int argc, char **argv) {
+  Settings settings;
+  Budget budget;
+  std::string traceDir = "Traces";
+  std::vector<std::string> files;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--traces" && hasValue) traceDir = argv[++i];
+    else if (arg == "--config" && hasValue) {
+      std::ifstream in(argv[++i]);
+      if (!in) { fprintf(stderr, "! Could not read %s\n", argv[i]); return 1; }
+      std::stringstream content;
+      content << in.rdbuf();
+      settings.config = content.str();
+    }
+    else if (arg == "--loop-us" && hasValue) settings.loop_us = strtoul(argv[++i], nullptr, 10);
+    else if (arg == "--sd-us" && hasValue) settings.sd_us = strtoul(argv[++i], nullptr, 10);
+    else if (arg == "--sps" && hasValue) settings.sps = atof(argv[++i]);
+    else if (arg == "--ignition-budget" && hasValue) budget.ignitionLatency_ms = atof(argv[++i]);
+    else if (arg == "--burnout-budget" && hasValue) budget.burnoutLatency_ms = atof(argv[++i]);
+    else if (arg == "--max-regressions" && hasValue) budget.maxRegressions = atoi(argv[++i]);
+    else if (arg == "--min-coverage" && hasValue) budget.minBurnCoverage = atof(argv[++i]);
+    else if (arg == "--tests" && hasValue) settings.tests = std::max(1, atoi(argv[++i]));
+    else if (arg == "-v") settings.verbose = true;
+    else if (arg[0] != '-') files.push_back(arg);
+    else { PrintUsage(); return 1; }
+  }
+
+  std::vector<ReplayCase> corpus;
+  if (files.empty()) {
+    corpus = BuiltInCorpus(traceDir);
+  } else {
+    for (const std::string &file : files) {
+      PointTrace trace;
+      if (!LoadTrace(file, trace)) { fprintf(stderr, "! Could not load a trace from %s\n", file.c_str()); return 1; }
+      ReplayCase c;
+      c.name = file.substr(file.find_last_of('/') + 1);
+      c.thrust = trace;
+      c.duration_s = trace.points.back().first;
+      c.budget = budget;
+      corpus.push_back(c);
+    }
+  }
+
+  int failures = 0;
+  printf("%-16s %14s %16s %9s %8s %9s  %s\n", "Trace", "Ignition_ms", "Burnout_ms", "Regress", "Logged", "Burn_Cov", "Result");
+
+  for (const ReplayCase &c : corpus) {
+    ReplayResult r;
+    std::string why;
+    if (!RunCase(c, settings, r)) why = "firmware crashed; ";
+    bool pass = why.empty() && Check(r, c.budget, why);
+    if (!pass) failures++;
+
+    char ignition[32], burnout[32], regress[16];
+    snprintf(ignition, sizeof(ignition), "%.0f/%.0f", r.ignitionLatency_ms, c.budget.ignitionLatency_ms);
+    snprintf(burnout, sizeof(burnout), "%.0f/%.0f", r.burnoutLatency_ms, c.budget.burnoutLatency_ms);
+    snprintf(regress, sizeof(regress), "%d/%d", r.regressions, c.budget.maxRegressions);
+    printf("%-16s %14s %16s %9s %8ld %8.0f%%  %s%s\n", c.name.c_str(), ignition, burnout, regress, r.samplesLogged,
+           r.burnCoverage * 100, pass ? "PASS" : "FAIL: ", why.substr(0, why.size() >= 2 ? why.size() - 2 : 0).c_str());
+  }
+
+  printf("\n%d of %zu traces failed (latency columns are measured/budget)\n", failures, corpus.size());
+  return failures ? 1 : 0;
+}
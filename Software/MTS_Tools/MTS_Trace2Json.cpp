@@ -0,0 +1,96 @@
+/*
+MTS_Trace2Json - Converts a TRCnnnn.BIN from the trace build into Chrome/Perfetto trace JSON (host tool)
+
+This program is licenced under the Creative Commons Zero V1.0 Universal Licence
+
+- The file format is described in the firmware's src/Trace.cpp, the event word in include/Trace.h
+- Timestamps are 24-bit and wrap every ~67 s at 16 MHz, we unwrap them assuming events are never further apart than that
+- If the ring overflowed, the oldest regions lost their begin event - those ends are dropped
+- Open the output in https://ui.perfetto.dev or chrome://tracing
+
+Usage:
+  mts_trace2json <TRCnnnn.BIN> [output.json]   (default output: same name with .json)
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static uint16_t ReadU16(const uint8_t *p) { return (uint16_t) (p[0] | (p[1] << 8)); }
+static uint32_t ReadU32(const uint8_t *p) { return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24); }
+
+int main(int argc, char **argv) {
+  if (argc < 2 || argc > 3) { fprintf(stderr, "Usage: mts_trace2json <TRCnnnn.BIN> [output.json]\n"); return 1; }
+
+  std::string inPath = argv[1];
+  std::string outPath = argc == 3 ? argv[2] : inPath.substr(0, inPath.find_last_of('.')) + ".json";
+
+  FILE *in = fopen(inPath.c_str(), "rb");
+  if (!in) { perror(inPath.c_str()); return 1; }
+  std::vector<uint8_t> data;
+  uint8_t buffer[4096];
+  for (size_t n; (n = fread(buffer, 1, sizeof(buffer), in)) > 0;) data.insert(data.end(), buffer, buffer + n);
+  fclose(in);
+
+  // Header
+  if (data.size() < 11 || memcmp(data.data(), "MTST", 4) != 0) { fprintf(stderr, "! %s is not a trace file\n", inPath.c_str()); return 1; }
+  if (data[4] != 1) { fprintf(stderr, "! Unsupported trace version %d\n", data[4]); return 1; }
+  int nameCount = data[5];
+  double tick_us = ReadU16(&data[6]) / 1000.0;
+  size_t eventCount = ReadU16(&data[8]);
+  bool wrapped = data[10] != 0;
+
+  // Event names, null terminated
+  size_t pos = 11;
+  std::vector<std::string> names;
+  for (int i = 0; i < nameCount; i++) {
+    const uint8_t *end = (const uint8_t *) memchr(&data[pos], 0, data.size() - pos);
+    if (!end) { fprintf(stderr, "! Truncated name table\n"); return 1; }
+    names.emplace_back((const char *) &data[pos], end - &data[pos]);
+    pos = end - data.data() + 1;
+  }
+
+  if (data.size() < pos + eventCount * 4) {
+    fprintf(stderr, "! File has %zu of %zu events, converting what's there\n", (data.size() - pos) / 4, eventCount);
+    eventCount = (data.size() - pos) / 4;
+  }
+
+  FILE *out = fopen(outPath.c_str(), "w");
+  if (!out) { perror(outPath.c_str()); return 1; }
+  fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Motor Test Stand\"}}");
+
+  std::vector<int> open(128, 0);
+  uint64_t epoch = 0, first = 0;
+  uint32_t previous = 0;
+  size_t written = 0, dropped = 0;
+
+  for (size_t i = 0; i < eventCount; i++) {
+    uint32_t event = ReadU32(&data[pos + i * 4]);
+    int id = event >> 25;
+    bool begin = (event >> 24) & 1;
+    uint32_t ticks = event & 0x00FFFFFF;
+
+    if (i > 0 && ticks < previous) epoch += 1u << 24;
+    if (i == 0) first = ticks; // The timeline starts at the first event we have
+    previous = ticks;
+
+    if (begin) open[id]++;
+    else if (open[id] > 0) open[id]--;
+    else { dropped++; continue; }
+
+    std::string name = id < (int) names.size() ? names[id] : "Event" + std::to_string(id);
+    fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":1}", name.c_str(), begin ? "B" : "E", (epoch + ticks - first) * tick_us);
+    written++;
+  }
+
+  fprintf(out, "\n]}\n");
+  fclose(out);
+
+  printf("%zu events written to %s", written, outPath.c_str());
+  if (wrapped) printf(" (ring overflowed, only the last %zu events were kept%s)", eventCount, dropped ? ", unmatched ends dropped" : "");
+  printf("\n");
+  return 0;
+}